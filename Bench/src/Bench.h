@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace Bench
+{
+   using Clock = std::chrono::steady_clock;
+   using SuiteFunction = void(*)();
+
+   // Runs of each measurement; the fastest is reported, as it is the one least disturbed by the rest of the machine.
+   static const constexpr int REPETITIONS = 5;
+
+   struct Suite
+   {
+      std::string name;
+      SuiteFunction function;
+   };
+
+   std::vector<Suite>& GetSuites();
+
+   // Registers a suite from a static object in its own translation unit, so adding a benchmark never touches main.
+   struct SuiteRegistrar
+   {
+      SuiteRegistrar(const char* name, SuiteFunction function) { GetSuites().push_back({ name, function }); }
+   };
+
+   // Calls setup and then func, timing only func, and returns the fastest of the runs in seconds.
+   template<typename Setup, typename Func>
+   double Measure(Setup&& setup, Func&& func, int repetitions = REPETITIONS)
+   {
+      double best = std::numeric_limits<double>::max();
+      for (int i = 0; i < repetitions; ++i)
+      {
+         setup();
+         Clock::time_point start = Clock::now();
+         func();
+         best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+      }
+      return best;
+   }
+
+   template<typename Func>
+   double Measure(Func&& func, int repetitions = REPETITIONS)
+   {
+      return Measure([] {}, func, repetitions);
+   }
+
+   // Prints a row with the time of one run and the throughput in millions of items per second.
+   void Report(const std::string& name, double seconds, size_t items, const char* unit = "ops");
+
+   // Feeds a result into a sink the optimizer cannot see through, so the work producing it is not removed.
+   void Consume(uint64_t value);
+}
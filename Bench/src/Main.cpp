@@ -0,0 +1,43 @@
+#include "Bench.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+   volatile uint64_t s_sink = 0;
+}
+
+std::vector<Bench::Suite>& Bench::GetSuites()
+{
+   static std::vector<Suite> suites;
+   return suites;
+}
+
+void Bench::Report(const std::string& name, double seconds, size_t items, const char* unit)
+{
+   std::printf("  %-44s %10.3f ms %10.2f M%s/s\n", name.c_str(), seconds * 1e3, static_cast<double>(items) / seconds / 1e6, unit);
+}
+
+void Bench::Consume(uint64_t value)
+{
+   s_sink = s_sink + value;
+}
+
+// Runs every suite, or only those named on the command line.
+int main(int argc, char** argv)
+{
+   for (const Bench::Suite& suite : Bench::GetSuites())
+   {
+      bool selected = argc < 2;
+      for (int i = 1; i < argc && !selected; ++i)
+         selected = std::strcmp(argv[i], suite.name.c_str()) == 0;
+      if (!selected)
+         continue;
+
+      std::printf("%s\n", suite.name.c_str());
+      suite.function();
+      std::printf("\n");
+   }
+   return 0;
+}
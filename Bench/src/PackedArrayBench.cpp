@@ -0,0 +1,112 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Container/PackedArray.h"
+
+namespace
+{
+   using Symphony::Entity;
+
+   constexpr size_t POPULATION = 1 << 17;
+   constexpr size_t WAVE = 50000;
+
+   // A component the size of a position, where the sparse set work dominates, and one the size of a cache line, where
+   // moving and writing the components does.
+   struct Small
+   {
+      std::array<float, 2> values{};
+   };
+
+   struct Large
+   {
+      std::array<float, 16> values{};
+   };
+
+   std::vector<Entity> MakeEntities(size_t first, size_t count)
+   {
+      std::vector<Entity> entities(count);
+      for (size_t i = 0; i < count; ++i)
+         entities[i] = Symphony::MakeEntity(static_cast<Entity>(first + i), 0);
+      return entities;
+   }
+
+   template<typename Comp>
+   std::unique_ptr<Symphony::PackedArray<Entity, Comp>> MakeArray(const std::vector<Entity>& entities)
+   {
+      auto array = std::make_unique<Symphony::PackedArray<Entity, Comp>>();
+      for (Entity entity : entities)
+         array->Add(entity, Comp{});
+      return array;
+   }
+
+   // Removes the same entities from a fresh population one at a time and batched.
+   template<typename Comp>
+   void CompareRemoval(const std::string& name, const std::vector<Entity>& population, const std::vector<Entity>& removed)
+   {
+      std::unique_ptr<Symphony::PackedArray<Entity, Comp>> array;
+      auto populate = [&] { array = MakeArray<Comp>(population); };
+
+      double seconds = Bench::Measure(populate, [&]
+      {
+         for (Entity entity : removed)
+            array->Remove(entity);
+      });
+      Bench::Report(name + "Remove loop", seconds, removed.size());
+
+      seconds = Bench::Measure(populate, [&] { array->RemoveRange(removed); });
+      Bench::Report(name + "RemoveRange", seconds, removed.size());
+
+      Bench::Consume(array->Size());
+   }
+
+   template<typename Comp>
+   void RunBatches(const std::string& component)
+   {
+      const std::vector<Entity> population = MakeEntities(0, POPULATION);
+      const std::vector<Entity> wave = MakeEntities(POPULATION, WAVE);
+      const std::string prefix = component + " / wave of " + std::to_string(WAVE) + " / ";
+
+      // A wave spawned into a population, each component built from its index. The array lives across the
+      // measurements, as it would across frames, so neither side pays for growing it.
+      std::unique_ptr<Symphony::PackedArray<Entity, Comp>> array = MakeArray<Comp>(population);
+      auto despawn = [&] { array->RemoveRange(wave); };
+
+      double seconds = Bench::Measure(despawn, [&]
+      {
+         for (size_t i = 0; i < wave.size(); ++i)
+            array->Add(wave[i], Comp{ { static_cast<float>(i) } });
+      });
+      Bench::Report(prefix + "Add loop", seconds, WAVE);
+
+      seconds = Bench::Measure(despawn, [&]
+      {
+         array->AddRange(wave, [](size_t i) { return Comp{ { static_cast<float>(i) } }; });
+      });
+      Bench::Report(prefix + "AddRange", seconds, WAVE);
+
+      // The same wave despawned again. It is the tail of the array, so the loop moves half of it into the other half.
+      std::vector<Entity> withWave = population;
+      withWave.insert(withWave.end(), wave.begin(), wave.end());
+      CompareRemoval<Comp>(prefix, withWave, wave);
+
+      // Entities picked at random from the whole population, as deaths scattered over a frame would be
+      std::vector<Entity> scattered = population;
+      std::shuffle(scattered.begin(), scattered.end(), std::mt19937(11));
+      scattered.resize(WAVE);
+      CompareRemoval<Comp>(component + " / scattered " + std::to_string(WAVE) + " / ", population, scattered);
+   }
+
+   void RunPackedArrayBatches()
+   {
+      RunBatches<Small>("8 bytes");
+      RunBatches<Large>("64 bytes");
+   }
+
+   Bench::SuiteRegistrar s_packedArrayBatches("PackedArrayBatch", &RunPackedArrayBatches);
+}
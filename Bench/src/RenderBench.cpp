@@ -0,0 +1,98 @@
+#include "Bench.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Rendering/RenderTarget.h"
+#include "Rendering/TextRenderer.h"
+
+namespace
+{
+   using namespace Cypher;
+
+   constexpr SHORT WIDTH = 240;
+   constexpr SHORT HEIGHT = 80;
+
+   // Draws per measurement, so a single run is long enough to time.
+   constexpr int DRAWS = 2000;
+
+   constexpr Pixel GLYPH = Pixel::HALF;
+
+   // Cells one call of draw writes, found by drawing on a blank target and counting what changed.
+   size_t CountCells(const std::function<void(TextRenderer&, int)>& draw)
+   {
+      RenderTarget blank(WIDTH, HEIGHT);
+      RenderTarget target(WIDTH, HEIGHT);
+      TextRenderer renderer(target);
+      draw(renderer, 0);
+      return target.CountDifferences(blank);
+   }
+
+   // Times DRAWS calls of draw, each given its index so the colour changes and no call is a repeat of the last.
+   void Run(const std::string& name, RenderTarget& target, const std::function<void(TextRenderer&, int)>& draw)
+   {
+      TextRenderer renderer(target);
+      double seconds = Bench::Measure([&]
+      {
+         for (int i = 0; i < DRAWS; ++i)
+            draw(renderer, i);
+      });
+      Bench::Report(name, seconds, CountCells(draw) * DRAWS, "cells");
+   }
+
+   SHORT ColorOf(int draw)
+   {
+      return static_cast<SHORT>(1 + draw % 15);
+   }
+
+   void RunRendering()
+   {
+      RenderTarget target(WIDTH, HEIGHT);
+
+      Sprite sprite(16, 8);
+      for (int y = 0; y < 8; ++y)
+      {
+         for (int x = 0; x < 16; ++x)
+         {
+            sprite.SetGlyph(x, y, Pixel::FULL);
+            sprite.SetColor(x, y, x);
+         }
+      }
+
+      const std::vector<Vector2f> hexagon = { { 30.0f, 0.0f }, { 15.0f, 26.0f }, { -15.0f, 26.0f }, { -30.0f, 0.0f }, { -15.0f, -26.0f }, { 15.0f, -26.0f } };
+
+      // The whole screen, as every frame starts
+      Run("Clear", target, [](TextRenderer& renderer, int) { renderer.Clear(); });
+
+      // A 200x60 block, first one Draw per cell in the column order Fill used to take, as the baseline for the spans
+      Run("200x60 / Draw per cell", target, [](TextRenderer& renderer, int i)
+      {
+         for (int x = 10; x < 210; ++x)
+         {
+            for (int y = 10; y < 70; ++y)
+               renderer.Draw(x, y, GLYPH, ColorOf(i));
+         }
+      });
+      Run("200x60 / Fill", target, [](TextRenderer& renderer, int i) { renderer.Fill(10, 10, 210, 70, GLYPH, ColorOf(i)); });
+      Run("200x60 / FillRectangle", target, [](TextRenderer& renderer, int i) { renderer.FillRectangle(10, 10, SHORT(200), SHORT(60), GLYPH, ColorOf(i)); });
+
+      // Half off the right edge, so clipping is part of the cost
+      Run("200x60 clipped / Fill", target, [](TextRenderer& renderer, int i) { renderer.Fill(140, 10, 340, 70, GLYPH, ColorOf(i)); });
+
+      Run("FillCircle r35", target, [](TextRenderer& renderer, int i) { renderer.FillCircle(120, 40, SHORT(35), GLYPH, ColorOf(i)); });
+      Run("FillTriangle", target, [](TextRenderer& renderer, int i) { renderer.FillTriangle(10, 75, 120, 5, 230, 75, GLYPH, ColorOf(i)); });
+      Run("FillPolygon hexagon", target, [&hexagon](TextRenderer& renderer, int i) { renderer.FillPolygon(hexagon, 120, 40, 0.3f, 1.0f, GLYPH, ColorOf(i)); });
+
+      // A row of 16x8 sprites across the screen
+      Run("DrawSprite 16x8 x 14", target, [&sprite](TextRenderer& renderer, int i)
+      {
+         for (int k = 0; k < 14; ++k)
+            renderer.DrawSprite(k * 17, i % (HEIGHT - 8), sprite);
+      });
+
+      Bench::Consume(target.GetCells()[WIDTH + 20].Attributes);
+   }
+
+   Bench::SuiteRegistrar s_rendering("Rendering", &RunRendering);
+}
@@ -0,0 +1,243 @@
+#include "Bench.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Container/SparseSet.h"
+
+namespace
+{
+   using Key = Symphony::Entity;
+   using Value = size_t;
+   using PagedSet = Symphony::SparseSet<Key, Value>;
+
+   constexpr size_t KEY_COUNT = 1 << 18;
+   constexpr size_t KEY_RANGE = size_t(1) << Symphony::ENTITY_INDEX_BITS;
+
+   // The layout SparseSet used before its page table: a std::map from page index to a bucket of offsets kept sorted,
+   // with their values alongside, searched with lower_bound and shifted on every insert and erase. Reproduced here so
+   // both layouts run on the same keys.
+   class MapSparseSet
+   {
+   public:
+      static constexpr size_t SHIFT = PagedSet::SPARSE_BUCKET_SHIFT;
+      static constexpr size_t BUCKET_SIZE = PagedSet::SPARSE_BUCKET_SIZE;
+      static constexpr Value INVALID_VALUE = PagedSet::INVALID_VALUE;
+
+      size_t Insert(Key key, Value value)
+      {
+         std::unique_ptr<Bucket>& bucket = m_sparse[key >> SHIFT];
+         if (!bucket)
+            bucket = std::make_unique<Bucket>();
+
+         Key offset = key & (BUCKET_SIZE - 1);
+         Key* position = std::lower_bound(bucket->offsets, bucket->offsets + bucket->size, offset);
+         size_t index = position - bucket->offsets;
+         if (index < bucket->size && *position == offset)
+            return bucket->values[index];
+
+         std::move_backward(bucket->offsets + index, bucket->offsets + bucket->size, bucket->offsets + bucket->size + 1);
+         std::move_backward(bucket->values + index, bucket->values + bucket->size, bucket->values + bucket->size + 1);
+         bucket->offsets[index] = offset;
+         bucket->values[index] = value;
+         ++bucket->size;
+
+         m_dense.push_back(key);
+         return m_dense.size() - 1;
+      }
+
+      Value Get(Key key) const
+      {
+         const Value* slot = Find(key);
+         return slot ? *slot : INVALID_VALUE;
+      }
+
+      bool Contains(Key key) const { return Find(key) != nullptr; }
+
+      void Remove(Key key)
+      {
+         auto it = m_sparse.find(key >> SHIFT);
+         if (it == m_sparse.end())
+            return;
+
+         Bucket& bucket = *it->second;
+         Key offset = key & (BUCKET_SIZE - 1);
+         Key* position = std::lower_bound(bucket.offsets, bucket.offsets + bucket.size, offset);
+         size_t index = position - bucket.offsets;
+         if (index == bucket.size || *position != offset)
+            return;
+
+         Value removedIndex = bucket.values[index];
+         std::move(bucket.offsets + index + 1, bucket.offsets + bucket.size, bucket.offsets + index);
+         std::move(bucket.values + index + 1, bucket.values + bucket.size, bucket.values + index);
+         --bucket.size;
+
+         if (removedIndex != m_dense.size() - 1)
+         {
+            Key last = m_dense.back();
+            m_dense[removedIndex] = last;
+            *Find(last) = removedIndex;
+         }
+         m_dense.pop_back();
+      }
+
+      size_t Size() const { return m_dense.size(); }
+
+   private:
+      struct Bucket
+      {
+         size_t size = 0;
+         Key offsets[BUCKET_SIZE];
+         Value values[BUCKET_SIZE];
+      };
+
+      Value* Find(Key key) const
+      {
+         auto it = m_sparse.find(key >> SHIFT);
+         if (it == m_sparse.end())
+            return nullptr;
+
+         const Bucket& bucket = *it->second;
+         Key offset = key & (BUCKET_SIZE - 1);
+         const Key* position = std::lower_bound(bucket.offsets, bucket.offsets + bucket.size, offset);
+         size_t index = position - bucket.offsets;
+         return index < bucket.size && *position == offset ? const_cast<Value*>(&bucket.values[index]) : nullptr;
+      }
+
+      std::map<size_t, std::unique_ptr<Bucket>> m_sparse;
+      std::vector<Key> m_dense;
+   };
+
+   struct KeySet
+   {
+      std::string name;
+      std::vector<Key> present;   // In insertion and lookup order
+      std::vector<Key> absent;    // Never inserted, for lookups that miss
+   };
+
+   KeySet MakeSequentialKeys()
+   {
+      KeySet keys;
+      keys.name = "sequential";
+      keys.present.resize(KEY_COUNT);
+      keys.absent.resize(KEY_COUNT);
+      std::iota(keys.present.begin(), keys.present.end(), Key(0));
+      std::iota(keys.absent.begin(), keys.absent.end(), Key(KEY_COUNT));
+      return keys;
+   }
+
+   // Keys scattered over the whole entity index range, inserted and looked up in random order.
+   KeySet MakeRandomKeys()
+   {
+      std::vector<Key> all(KEY_RANGE);
+      std::iota(all.begin(), all.end(), Key(0));
+      std::shuffle(all.begin(), all.end(), std::mt19937(42));
+
+      KeySet keys;
+      keys.name = "random";
+      keys.present.assign(all.begin(), all.begin() + KEY_COUNT);
+      keys.absent.assign(all.begin() + KEY_COUNT, all.begin() + 2 * KEY_COUNT);
+      return keys;
+   }
+
+   template<typename Set>
+   void Fill(Set& set, const std::vector<Key>& keys)
+   {
+      for (Key key : keys)
+         set.Insert(key, set.Size());
+   }
+
+   template<typename Set>
+   void RunLayout(const std::string& layout, const KeySet& keys)
+   {
+      const std::string prefix = keys.name + " / " + layout + " ";
+      std::unique_ptr<Set> set;
+
+      double seconds = Bench::Measure([&] { set = std::make_unique<Set>(); }, [&] { Fill(*set, keys.present); });
+      Bench::Report(prefix + "insert", seconds, keys.present.size());
+
+      set = std::make_unique<Set>();
+      Fill(*set, keys.present);
+
+      seconds = Bench::Measure([&]
+      {
+         uint64_t sum = 0;
+         for (Key key : keys.present)
+            sum += set->Get(key);
+         Bench::Consume(sum);
+      });
+      Bench::Report(prefix + "get", seconds, keys.present.size());
+
+      seconds = Bench::Measure([&]
+      {
+         uint64_t found = 0;
+         for (Key key : keys.absent)
+            found += set->Contains(key);
+         Bench::Consume(found);
+      });
+      Bench::Report(prefix + "contains (miss)", seconds, keys.absent.size());
+
+      seconds = Bench::Measure([&] { set = std::make_unique<Set>(); Fill(*set, keys.present); }, [&]
+      {
+         for (Key key : keys.present)
+            set->Remove(key);
+      });
+      Bench::Report(prefix + "remove", seconds, keys.present.size());
+   }
+
+   void RunSparseSetLayouts()
+   {
+      for (const KeySet& keys : { MakeSequentialKeys(), MakeRandomKeys() })
+      {
+         RunLayout<MapSparseSet>("map", keys);
+         RunLayout<PagedSet>("paged", keys);
+      }
+   }
+
+   // A wave of spawns and despawns against a set that already holds a population, one key at a time and batched. The
+   // set lives across the measurements, as it would across frames, so only the first wave finds it short of capacity.
+   void RunWave(const KeySet& keys)
+   {
+      constexpr size_t POPULATION = KEY_COUNT / 2;
+      constexpr size_t WAVE = 50000;
+
+      const std::vector<Key> population(keys.present.begin(), keys.present.begin() + POPULATION);
+      const std::vector<Key> wave(keys.absent.begin(), keys.absent.begin() + WAVE);
+      const std::string prefix = keys.name + " wave of " + std::to_string(WAVE) + " / ";
+
+      PagedSet set;
+      Fill(set, population);
+      auto withoutWave = [&] { set.RemoveRange(wave); };
+      auto withWave = [&] { set.InsertRange(wave); };
+
+      double seconds = Bench::Measure(withoutWave, [&] { Fill(set, wave); });
+      Bench::Report(prefix + "Insert loop", seconds, WAVE);
+
+      seconds = Bench::Measure(withoutWave, [&] { set.InsertRange(wave); });
+      Bench::Report(prefix + "InsertRange", seconds, WAVE);
+
+      seconds = Bench::Measure(withWave, [&]
+      {
+         for (Key key : wave)
+            set.Remove(key);
+      });
+      Bench::Report(prefix + "Remove loop", seconds, WAVE);
+
+      seconds = Bench::Measure(withWave, [&] { set.RemoveRange(wave); });
+      Bench::Report(prefix + "RemoveRange", seconds, WAVE);
+   }
+
+   void RunSparseSetBatches()
+   {
+      for (const KeySet& keys : { MakeSequentialKeys(), MakeRandomKeys() })
+         RunWave(keys);
+   }
+
+   Bench::SuiteRegistrar s_layouts("SparseSetLayout", &RunSparseSetLayouts);
+   Bench::SuiteRegistrar s_batches("SparseSetBatch", &RunSparseSetBatches);
+}
@@ -0,0 +1,94 @@
+#include "Bench.h"
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ECS/TaskGraph.h"
+
+namespace
+{
+   using Symphony::ComponentMask;
+
+   // Stand-in for a system's per-entity work, heavy enough that the compiler cannot fold the loop away.
+   void Integrate(std::vector<float>& values)
+   {
+      for (float& value : values)
+         value = value * 0.999f + 0.5f;
+   }
+
+   float Sum(const std::vector<float>& values)
+   {
+      float sum = 0.0f;
+      for (float value : values)
+         sum += value;
+      return sum;
+   }
+
+   // Times one frame of the systems run one after another and the same systems run through a TaskGraph.
+   void Compare(const std::string& name, const std::vector<std::function<void()>>& systems, Symphony::TaskGraph& graph, size_t elements)
+   {
+      double seconds = Bench::Measure([&]
+      {
+         for (const std::function<void()>& system : systems)
+            system();
+      });
+      Bench::Report(name + " / serial", seconds, elements, "elements");
+
+      graph.Run();
+      seconds = Bench::Measure([&] { graph.Run(); });
+      Bench::Report(name + " / TaskGraph", seconds, elements, "elements");
+   }
+
+   // Each system writes a component of its own, so none conflicts with another.
+   void RunWriters(size_t systemCount, size_t elementCount)
+   {
+      std::vector<std::vector<float>> components(systemCount, std::vector<float>(elementCount, 1.0f));
+      std::vector<std::function<void()>> systems;
+      Symphony::TaskGraph graph;
+      for (size_t i = 0; i < systemCount; ++i)
+      {
+         std::vector<float>& values = components[i];
+         systems.push_back([&values] { Integrate(values); });
+         graph.AddSystem("Writer" + std::to_string(i), 0, ComponentMask(1) << i, systems.back());
+      }
+
+      Compare(std::to_string(systemCount) + " writers x " + std::to_string(elementCount), systems, graph, systemCount * elementCount);
+   }
+
+   // Many small systems that only read the same components and keep their results to themselves, the shape of a frame
+   // full of queries and stat gathering; mostly a measure of scheduling overhead.
+   void RunReaders(size_t systemCount, size_t elementCount)
+   {
+      const std::vector<float> shared(elementCount, 1.0f);
+      std::vector<float> results(systemCount);
+      std::vector<std::function<void()>> systems;
+      Symphony::TaskGraph graph;
+      for (size_t i = 0; i < systemCount; ++i)
+      {
+         float& result = results[i];
+         systems.push_back([&shared, &result] { result = Sum(shared); });
+         graph.AddSystem("Reader" + std::to_string(i), ComponentMask(1) << (i % 64), 0, systems.back());
+      }
+
+      Compare(std::to_string(systemCount) + " readers x " + std::to_string(elementCount), systems, graph, systemCount * elementCount);
+
+      float total = 0.0f;
+      for (float result : results)
+         total += result;
+      Bench::Consume(static_cast<uint64_t>(total));
+   }
+
+   void RunTaskGraph()
+   {
+      std::printf("  %zu workers plus the calling thread\n", Symphony::JobSystem::GetDefault().WorkerCount());
+
+      RunWriters(64, 16384);
+      RunWriters(64, 1024);
+      RunReaders(256, 4096);
+      RunReaders(1024, 256);
+   }
+
+   Bench::SuiteRegistrar s_taskGraph("TaskGraph", &RunTaskGraph);
+}
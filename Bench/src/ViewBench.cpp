@@ -0,0 +1,206 @@
+#include "Bench.h"
+
+#include <random>
+#include <string>
+
+#include <entt/entt.hpp>
+
+#include "ECS/View.h"
+
+namespace
+{
+   using Symphony::Entity;
+
+   constexpr size_t ENTITY_COUNT = 1 << 18;
+
+   struct Position { float x = 0.0f, y = 0.0f; };
+   struct Velocity { float x = 0.0f, y = 0.0f; };
+   struct Health { int32_t value = 100; };
+   struct Frozen { bool frozen = true; };
+
+   // Every entity has a Position; Velocity, Health and Frozen are spread at random over half, a tenth and a quarter of
+   // them. Both worlds are built from the same draws in the same order, so their storage is laid out alike.
+   struct Membership
+   {
+      bool velocity;
+      bool health;
+      bool frozen;
+   };
+
+   std::vector<Membership> MakeMembership()
+   {
+      std::mt19937 random(7);
+      std::uniform_int_distribution<int> percent(0, 99);
+      std::vector<Membership> membership(ENTITY_COUNT);
+      for (Membership& entry : membership)
+         entry = { percent(random) < 50, percent(random) < 10, percent(random) < 25 };
+      return membership;
+   }
+
+   struct SymphonyWorld
+   {
+      Symphony::PackedArray<Entity, Position> positions;
+      Symphony::PackedArray<Entity, Velocity> velocities;
+      Symphony::PackedArray<Entity, Health> healths;
+      Symphony::PackedArray<Entity, Frozen> frozen;
+
+      explicit SymphonyWorld(const std::vector<Membership>& membership)
+      {
+         for (size_t i = 0; i < membership.size(); ++i)
+         {
+            Entity entity = Symphony::MakeEntity(static_cast<Entity>(i), 0);
+            positions.Add(entity, Position{ static_cast<float>(i), 0.0f });
+            if (membership[i].velocity)
+               velocities.Add(entity, Velocity{ 1.0f, 2.0f });
+            if (membership[i].health)
+               healths.Add(entity, Health{});
+            if (membership[i].frozen)
+               frozen.Add(entity, Frozen{});
+         }
+      }
+   };
+
+   struct EnttWorld
+   {
+      entt::registry registry;
+
+      explicit EnttWorld(const std::vector<Membership>& membership)
+      {
+         for (size_t i = 0; i < membership.size(); ++i)
+         {
+            entt::entity entity = registry.create();
+            registry.emplace<Position>(entity, static_cast<float>(i), 0.0f);
+            if (membership[i].velocity)
+               registry.emplace<Velocity>(entity, 1.0f, 2.0f);
+            if (membership[i].health)
+               registry.emplace<Health>(entity);
+            if (membership[i].frozen)
+               registry.emplace<Frozen>(entity);
+         }
+      }
+   };
+
+   template<typename View>
+   size_t CountMatches(View& view)
+   {
+      size_t count = 0;
+      view.Each([&count](auto&&...) { ++count; });
+      return count;
+   }
+
+   void Report(const std::string& name, double seconds, size_t matches)
+   {
+      Bench::Report(name, seconds, matches, "entities");
+   }
+
+   void RunViews()
+   {
+      const std::vector<Membership> membership = MakeMembership();
+      SymphonyWorld symphony(membership);
+      EnttWorld entt(membership);
+
+      // Two components, the pivot is the half with a Velocity
+      {
+         auto view = Symphony::View<Position, Velocity>(symphony.positions, symphony.velocities);
+         size_t matches = CountMatches(view);
+         double seconds = Bench::Measure([&]
+         {
+            view.Each([](Entity, Position& position, Velocity& velocity)
+            {
+               position.x += velocity.x;
+               position.y += velocity.y;
+            });
+         });
+         Report("Position+Velocity / Symphony Each", seconds, matches);
+
+         seconds = Bench::Measure([&]
+         {
+            for (auto [entity, position, velocity] : view)
+            {
+               position.x += velocity.x;
+               position.y += velocity.y;
+            }
+         });
+         Report("Position+Velocity / Symphony iterator", seconds, matches);
+
+         auto enttView = entt.registry.view<Position, Velocity>();
+         seconds = Bench::Measure([&]
+         {
+            enttView.each([](entt::entity, Position& position, Velocity& velocity)
+            {
+               position.x += velocity.x;
+               position.y += velocity.y;
+            });
+         });
+         Report("Position+Velocity / entt each", seconds, matches);
+
+         seconds = Bench::Measure([&]
+         {
+            for (auto [entity, position, velocity] : enttView.each())
+            {
+               position.x += velocity.x;
+               position.y += velocity.y;
+            }
+         });
+         Report("Position+Velocity / entt iterator", seconds, matches);
+      }
+
+      // Three components, the pivot is the tenth with Health, listed last so picking it is the view's job
+      {
+         auto view = Symphony::View<Position, Velocity, Health>(symphony.positions, symphony.velocities, symphony.healths);
+         size_t matches = CountMatches(view);
+         double seconds = Bench::Measure([&]
+         {
+            uint64_t sum = 0;
+            view.Each([&sum](Entity, Position& position, Velocity& velocity, Health& health)
+            {
+               position.x += velocity.x;
+               sum += health.value;
+            });
+            Bench::Consume(sum);
+         });
+         Report("Position+Velocity+Health / Symphony Each", seconds, matches);
+
+         auto enttView = entt.registry.view<Position, Velocity, Health>();
+         seconds = Bench::Measure([&]
+         {
+            uint64_t sum = 0;
+            enttView.each([&sum](entt::entity, Position& position, Velocity& velocity, Health& health)
+            {
+               position.x += velocity.x;
+               sum += health.value;
+            });
+            Bench::Consume(sum);
+         });
+         Report("Position+Velocity+Health / entt each", seconds, matches);
+      }
+
+      // Two components minus the frozen quarter
+      {
+         auto view = Symphony::FilteredView<Symphony::Include<Position, Velocity>, Symphony::Exclude<Frozen>>(symphony.positions, symphony.velocities, symphony.frozen);
+         size_t matches = CountMatches(view);
+         double seconds = Bench::Measure([&]
+         {
+            view.Each([](Entity, Position& position, Velocity& velocity)
+            {
+               position.x += velocity.x;
+               position.y += velocity.y;
+            });
+         });
+         Report("Position+Velocity-Frozen / Symphony Each", seconds, matches);
+
+         auto enttView = entt.registry.view<Position, Velocity>(entt::exclude<Frozen>);
+         seconds = Bench::Measure([&]
+         {
+            enttView.each([](entt::entity, Position& position, Velocity& velocity)
+            {
+               position.x += velocity.x;
+               position.y += velocity.y;
+            });
+         });
+         Report("Position+Velocity-Frozen / entt each", seconds, matches);
+      }
+   }
+
+   Bench::SuiteRegistrar s_views("View", &RunViews);
+}
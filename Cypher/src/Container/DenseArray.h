@@ -1,7 +1,12 @@
 
+#pragma once
+
 #include <vector>
 #include <unordered_map>
 #include <cassert>
+#include <memory>
+
+#include "../ECS/Defines.h"
 
 namespace Symphony
 {
@@ -67,4 +72,126 @@ namespace Symphony
       KeyToIndexMap m_keyToIndex;
       IndexToKeyMap m_indexToKey;
    };
+
+   // DenseArray variant addressed purely by dense index. It keeps no key lookup of its own; the owner (typically a
+   // SparseSet) maps keys to indices and is told which key, if any, was swapped into a removed slot.
+   template<typename Key, Component Comp, typename Allocator = std::allocator<Comp>>
+   class IndexedDenseArray
+   {
+   public:
+      using ComponentVector = std::vector<Comp, Allocator>;
+      using KeyVector = std::vector<Key, RebindAlloc<Allocator, Key>>;
+
+      struct MovedKey
+      {
+         Key key;       // Key that now lives at index
+         size_t index;
+         bool moved;    // False when the removed element was last and nothing was swapped
+      };
+
+      IndexedDenseArray() = default;
+
+      // Both vectors allocate through the given allocator, so they can live in a caller-supplied arena.
+      explicit IndexedDenseArray(const Allocator& allocator) :
+         m_components(allocator),
+         m_keys(allocator)
+      {}
+
+      size_t Add(Key key, const Comp& component)
+      {
+         m_components.push_back(component);
+         m_keys.push_back(key);
+         return m_components.size() - 1;
+      }
+
+      size_t Add(Key key, Comp&& component)
+      {
+         m_components.push_back(std::move(component));
+         m_keys.push_back(key);
+         return m_components.size() - 1;
+      }
+
+      MovedKey Remove(size_t index)
+      {
+         assert(index < m_components.size() && "Index out of range");
+
+         size_t last = m_components.size() - 1;
+         MovedKey record = { m_keys[last], index, index != last };
+         if (record.moved)
+         {
+            m_components[index] = std::move(m_components[last]);
+            m_keys[index] = m_keys[last];
+         }
+         m_components.pop_back();
+         m_keys.pop_back();
+         return record;
+      }
+
+      // Moves the element at from into the slot at to, overwriting it. from is left moved-from until truncated.
+      void Move(size_t from, size_t to)
+      {
+         assert(from < m_components.size() && to < m_components.size() && "Index out of range");
+         m_components[to] = std::move(m_components[from]);
+         m_keys[to] = m_keys[from];
+      }
+
+      void Swap(size_t lhs, size_t rhs)
+      {
+         assert(lhs < m_components.size() && rhs < m_components.size() && "Index out of range");
+         std::swap(m_components[lhs], m_components[rhs]);
+         std::swap(m_keys[lhs], m_keys[rhs]);
+      }
+
+      // Drops every element at or past size.
+      void Truncate(size_t size)
+      {
+         if (size >= m_components.size())
+            return;
+
+         m_components.erase(m_components.begin() + size, m_components.end());
+         m_keys.erase(m_keys.begin() + size, m_keys.end());
+      }
+
+      Comp& Get(size_t index)
+      {
+         assert(index < m_components.size() && "Index out of range");
+         return m_components[index];
+      }
+
+      const Comp& Get(size_t index) const
+      {
+         assert(index < m_components.size() && "Index out of range");
+         return m_components[index];
+      }
+
+      Key GetKey(size_t index) const
+      {
+         assert(index < m_keys.size() && "Index out of range");
+         return m_keys[index];
+      }
+
+      void Reserve(size_t capacity)
+      {
+         m_components.reserve(capacity);
+         m_keys.reserve(capacity);
+      }
+
+      void Clear()
+      {
+         m_components.clear();
+         m_keys.clear();
+      }
+
+      size_t Size() const { return m_components.size(); }
+
+      Comp* Data() { return m_components.data(); }
+      const Comp* Data() const { return m_components.data(); }
+      const Key* Keys() const { return m_keys.data(); }
+
+      const ComponentVector& GetAllComponents() const { return m_components; }
+
+   private:
+      ComponentVector m_components;
+      KeyVector m_keys;
+   };
 }
\ No newline at end of file
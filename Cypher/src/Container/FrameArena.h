@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "../Common.h"
+#include "../Core/Memory.h"
+#include "../ECS/Defines.h"
+
+namespace Symphony
+{
+   // Monotonic arena for memory that lives at most one frame. Allocation is a bump of an atomic offset into the current
+   // block, so any thread may allocate concurrently; individual frees are no-ops. Reset, called once per frame when no
+   // frame allocation is still in use, rewinds to the first block and keeps every block for reuse, so a steady frame
+   // workload stops requesting memory after its first peak.
+   class FrameArena
+   {
+   public:
+      static constexpr size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+      static constexpr size_t BLOCK_ALIGNMENT = 64;
+
+      explicit FrameArena(size_t blockSize = DEFAULT_BLOCK_SIZE) :
+         m_blockSize(blockSize),
+         m_current(nullptr),
+         m_currentIndex(0),
+         m_highWater(0)
+      {}
+
+      FrameArena(const FrameArena&) = delete;
+      FrameArena& operator=(const FrameArena&) = delete;
+
+      ~FrameArena()
+      {
+         for (Block* block : m_blocks)
+            Cypher::Memory::Deallocate(block, sizeof(Block) + block->capacity, BLOCK_ALIGNMENT, Cypher::MemoryArena::ECS);
+      }
+
+      // Shared arena for callers that do not own one; never destroyed, like the pools behind PoolAllocator. The console
+      // resets it at the end of every frame, once no simulation tick is in progress.
+      static FrameArena& GetDefault()
+      {
+         static FrameArena* arena = new FrameArena();
+         return *arena;
+      }
+
+      [[nodiscard]] void* Allocate(size_t size, size_t alignment)
+      {
+         Assert(alignment <= BLOCK_ALIGNMENT);
+
+         for (;;)
+         {
+            Block* block = m_current.load(std::memory_order_acquire);
+            if (block)
+            {
+               // Reserve enough for the worst-case padding, then align inside the reservation
+               size_t offset = block->offset.fetch_add(size + alignment - 1, std::memory_order_relaxed);
+               size_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+               if (aligned + size <= block->capacity)
+                  return block->Data() + aligned;
+            }
+
+            Advance(block, size + alignment - 1);
+         }
+      }
+
+      // Starts a new frame. Every pointer handed out since the last Reset becomes invalid.
+      void Reset()
+      {
+         std::lock_guard<std::mutex> lock(m_lock);
+         m_highWater = std::max(m_highWater, BytesUsedLocked());
+
+         for (Block* block : m_blocks)
+            block->offset.store(0, std::memory_order_relaxed);
+
+         m_currentIndex = 0;
+         m_current.store(m_blocks.empty() ? nullptr : m_blocks.front(), std::memory_order_release);
+      }
+
+      size_t BytesUsed()
+      {
+         std::lock_guard<std::mutex> lock(m_lock);
+         return BytesUsedLocked();
+      }
+
+      // Largest number of bytes used by any frame that has been reset so far.
+      inline size_t HighWaterMark() const { return m_highWater; }
+
+      size_t BytesReserved()
+      {
+         std::lock_guard<std::mutex> lock(m_lock);
+         size_t reserved = 0;
+         for (Block* block : m_blocks)
+            reserved += block->capacity;
+         return reserved;
+      }
+
+   private:
+      struct alignas(BLOCK_ALIGNMENT) Block
+      {
+         std::atomic<size_t> offset;
+         size_t capacity;
+
+         inline std::byte* Data() { return reinterpret_cast<std::byte*>(this + 1); }
+      };
+
+      // Moves on from a block that could not fit a request, unless another thread already has.
+      void Advance(Block* exhausted, size_t required)
+      {
+         std::lock_guard<std::mutex> lock(m_lock);
+         if (m_current.load(std::memory_order_relaxed) != exhausted)
+            return;
+
+         size_t next = exhausted ? m_currentIndex + 1 : 0;
+         while (next < m_blocks.size() && m_blocks[next]->capacity < required)
+            ++next;
+
+         if (next == m_blocks.size())
+         {
+            size_t capacity = std::max(m_blockSize, required);
+            Block* block = new(Cypher::Memory::Allocate(sizeof(Block) + capacity, BLOCK_ALIGNMENT, Cypher::MemoryArena::ECS)) Block();
+            block->offset.store(0, std::memory_order_relaxed);
+            block->capacity = capacity;
+            m_blocks.push_back(block);
+         }
+
+         m_currentIndex = next;
+         m_current.store(m_blocks[next], std::memory_order_release);
+      }
+
+      size_t BytesUsedLocked() const
+      {
+         size_t used = 0;
+         for (size_t i = 0; i < m_blocks.size() && i <= m_currentIndex; ++i)
+            used += std::min(m_blocks[i]->offset.load(std::memory_order_relaxed), m_blocks[i]->capacity);
+         return used;
+      }
+
+      const size_t m_blockSize;
+
+      std::mutex m_lock;
+      std::vector<Block*> m_blocks;
+      std::atomic<Block*> m_current;
+      size_t m_currentIndex;
+      size_t m_highWater;
+   };
+
+   // Allocator drawing from a FrameArena. deallocate does nothing; the memory is reclaimed by the arena's next Reset, so
+   // containers using it must not outlive the frame.
+   template<typename T>
+   class FrameAllocator
+   {
+   public:
+      using value_type = T;
+
+      FrameAllocator() noexcept :
+         m_arena(&FrameArena::GetDefault())
+      {}
+
+      explicit FrameAllocator(FrameArena& arena) noexcept :
+         m_arena(&arena)
+      {}
+
+      template<typename U>
+      FrameAllocator(const FrameAllocator<U>& other) noexcept :
+         m_arena(other.GetArena())
+      {}
+
+      [[nodiscard]] T* allocate(size_t n) { return static_cast<T*>(m_arena->Allocate(n * sizeof(T), alignof(T))); }
+      void deallocate(T*, size_t) {}
+
+      inline FrameArena* GetArena() const { return m_arena; }
+
+      template<typename U>
+      bool operator==(const FrameAllocator<U>& other) const noexcept { return m_arena == other.GetArena(); }
+
+   private:
+      FrameArena* m_arena;
+   };
+
+   static_assert(Allocator<FrameAllocator<int>>);
+}
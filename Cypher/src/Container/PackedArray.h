@@ -1,58 +1,386 @@
 #pragma once
 
+#include <span>
+#include <utility>
+#include <vector>
+
 #include "../Common.h"
 #include "SparseSet.h"
 #include "DenseArray.h"
 
 namespace Symphony
 {
-   template<typename Entity, Component Comp>
+   template<typename Entity, Component Comp, typename Allocator = std::allocator<Comp>>
    class PackedArray
    {
+      using SparseSetType = SparseSet<Entity, size_t>;
+      using DenseArrayType = IndexedDenseArray<Entity, Comp, Allocator>;
+
    public:
+      // Lets one owner, such as a Group, keep its own ordering in step with structural changes. onAdded runs after a
+      // component is added, onRemoving before one is removed.
+      struct Observer
+      {
+         void* context = nullptr;
+         void (*onAdded)(void* context, Entity entity) = nullptr;
+         void (*onRemoving)(void* context, Entity entity) = nullptr;
+      };
+
+      static constexpr size_t INVALID_INDEX = SparseSetType::INVALID_VALUE;
+      static constexpr size_t CHANGE_CHUNK_SIZE = 64;
+
+      PackedArray() = default;
+
+      explicit PackedArray(const Allocator& allocator) :
+         m_denseArray(allocator)
+      {}
+
       void Add(Entity entity, const Comp& component)
       {
-         if (m_sparseSet.Contains(entity))
+         if (!MakeRoomFor(entity))
             return;
 
-         auto index = m_denseArray.Size();
-         m_sparseSet.Insert(entity, index);
-         m_denseArray.Add(index, component);
+         auto index = m_denseArray.Add(entity, component);
+         m_sparseSet.Insert(SparseKey(entity), index);
+         MarkAdded(index);
+         NotifyAdded(entity);
+      }
+
+      void Add(Entity entity, Comp&& component)
+      {
+         if (!MakeRoomFor(entity))
+            return;
+
+         auto index = m_denseArray.Add(entity, std::move(component));
+         m_sparseSet.Insert(SparseKey(entity), index);
+         MarkAdded(index);
+         NotifyAdded(entity);
+      }
+
+      // Adds a component for every listed entity that has none, by the same rules as Add, taking it from
+      // component(i) for entities[i]. The keys go into the sparse set in one InsertRange and the components are
+      // appended behind them in the same order, so both sides grow at most once and no component moves after it lands.
+      // An entity whose slot holds an older generation is added after the rest, once the occupant is removed. Once a
+      // component is added for an entity index, later entries with that index are skipped, whatever their generation.
+      // Returns the number of components added.
+      template<typename GetComponent>
+      size_t AddRange(std::span<const Entity> entities, GetComponent&& component)
+      {
+         m_keyBatch.resize(entities.size());
+         for (size_t i = 0; i < entities.size(); ++i)
+            m_keyBatch[i] = SparseKey(entities[i]);
+
+         const size_t oldSize = m_denseArray.Size();
+         m_denseArray.Reserve(oldSize + entities.size());
+
+         // Slots taken before the batch by an older generation are noted with their occupant, to be replaced below
+         m_replacements.clear();
+         const size_t added = m_sparseSet.InsertRange(m_keyBatch, [this, entities, oldSize](size_t i, size_t index)
+         {
+            if (index < oldSize && IsNewerGeneration(entities[i], m_denseArray.GetKey(index)))
+               m_replacements.push_back({ i, m_denseArray.GetKey(index) });
+         });
+
+         // The inserted keys are the batch minus the keys already present, in batch order. When the whole batch went
+         // in they line up with it; otherwise their sources are matched to them first.
+         if (added == entities.size())
+         {
+            for (size_t i = 0; i < added; ++i)
+               m_denseArray.Add(entities[i], component(i));
+         }
+         else
+         {
+            m_sourceBatch.resize(added);
+            const Entity* inserted = m_sparseSet.Data() + oldSize;
+            for (size_t index = 0, source = 0; index < added; ++index, ++source)
+            {
+               while (m_keyBatch[source] != inserted[index])
+                  ++source;
+               m_sourceBatch[index] = source;
+            }
+
+            for (size_t index = 0; index < added; ++index)
+               m_denseArray.Add(entities[m_sourceBatch[index]], component(m_sourceBatch[index]));
+         }
+
+         for (size_t index = oldSize; index < oldSize + added; index = (index / CHANGE_CHUNK_SIZE + 1) * CHANGE_CHUNK_SIZE)
+            MarkAdded(index);
+
+         // Observers may reorder the dense array, so they are told by entity once every component is in place
+         if (m_observer.onAdded)
+         {
+            for (size_t index = 0; index < added; ++index)
+               NotifyAdded(entities[added == entities.size() ? index : m_sourceBatch[index]]);
+         }
+
+         // An earlier replacement for the same index has already removed the occupant
+         size_t replaced = 0;
+         for (auto [i, occupant] : m_replacements)
+         {
+            if (!Contains(occupant))
+               continue;
+
+            Remove(occupant);
+            Add(entities[i], component(i));
+            ++replaced;
+         }
+         return added + replaced;
+      }
+
+      size_t AddRange(std::span<const Entity> entities, std::span<Comp> components)
+      {
+         Assert(entities.size() == components.size());
+         return AddRange(entities, [components](size_t i) -> Comp&& { return std::move(components[i]); });
       }
 
-      void Remove(Entity entity) {
-         size_t index = m_sparseSet[entity];
-         if (!index)
+      void Remove(Entity entity)
+      {
+         if (!Contains(entity))
             return;
 
+         // An observer may reorder the dense array, so the index is only looked up once it has been told
+         NotifyRemoving(entity);
+         size_t index = IndexOf(entity);
+
+         // Both sides swap-and-pop the same slot, so the sparse set already points the moved key at index
+         m_sparseSet.Remove(SparseKey(entity));
          m_denseArray.Remove(index);
+         MarkMoved(m_denseArray.Size(), index);
+         TrimChunkVersions();
+      }
 
-         if (index < m_denseArray.Size())
+      // Removes the components of every listed entity in one batched pass over the sparse set, which checks each
+      // entity's generation against the occupant of its slot as it goes.
+      void RemoveRange(std::span<const Entity> entities)
+      {
+         // An observer may reorder the dense array, so every removal is announced before any index is looked up
+         if (m_observer.onRemoving)
          {
-            Entity lastEntity = m_denseArray.GetKeyAtIndex(m_denseArray.Size() - 1);
-            m_sparseSet.Remove(lastEntity);
-            m_sparseSet.Insert(lastEntity, index);
+            for (Entity entity : entities)
+            {
+               if (Contains(entity))
+                  NotifyRemoving(entity);
+            }
          }
 
-         m_sparseSet.Remove(entity);
+         m_keyBatch.resize(entities.size());
+         for (size_t i = 0; i < entities.size(); ++i)
+            m_keyBatch[i] = SparseKey(entities[i]);
+
+         size_t removed = m_sparseSet.RemoveRange(m_keyBatch, [this, entities](size_t i, size_t index)
+         {
+            return m_denseArray.GetKey(index) == entities[i];
+         }, [this](size_t from, size_t to)
+         {
+            m_denseArray.Move(from, to);
+            MarkMoved(from, to);
+         });
+         m_denseArray.Truncate(m_denseArray.Size() - removed);
+         TrimChunkVersions();
       }
 
       Comp& Get(Entity entity)
       {
-         auto index = m_sparseSet[entity];
-         if (!index)
+         size_t index = IndexOf(entity);
+         if (index == INVALID_INDEX)
          {
             static Comp dummy;
             return dummy;
          }
 
-         return m_denseArray.GetByIndex(index);
+         return m_denseArray.Get(index);
+      }
+
+      // Like Get, but records the component as changed when change tracking is enabled.
+      Comp& GetMutable(Entity entity)
+      {
+         size_t index = IndexOf(entity);
+         if (index == INVALID_INDEX)
+            return Get(entity);
+
+         MarkChanged(index);
+         return m_denseArray.Get(index);
+      }
+
+      Comp& GetMutableAt(size_t index)
+      {
+         MarkChanged(index);
+         return m_denseArray.Get(index);
+      }
+
+      bool Contains(Entity entity) const { return IndexOf(entity) != INVALID_INDEX; }
+
+      // Exchanges the components at two dense indices.
+      void SwapAt(size_t lhs, size_t rhs)
+      {
+         if (lhs == rhs)
+            return;
+
+         m_sparseSet.Swap(SparseKey(m_denseArray.GetKey(lhs)), SparseKey(m_denseArray.GetKey(rhs)));
+         m_denseArray.Swap(lhs, rhs);
+         MarkMoved(lhs, rhs);
+         MarkMoved(rhs, lhs);
+      }
+
+      void SetObserver(const Observer& observer)
+      {
+         Assert(!m_observer.context || !observer.context);
+         m_observer = observer;
+      }
+
+      inline bool HasObserver() const { return m_observer.context != nullptr; }
+
+      // Dense index of the entity's component, or INVALID_INDEX. The sparse set is keyed by index bits only, so a stale
+      // handle whose index has been recycled finds the new owner's component there; comparing the stored key rejects it.
+      size_t IndexOf(Entity entity) const
+      {
+         size_t index = m_sparseSet.Get(SparseKey(entity));
+         if (index == INVALID_INDEX || !(m_denseArray.GetKey(index) == entity))
+            return INVALID_INDEX;
+         return index;
+      }
+
+      Comp& GetAt(size_t index) { return m_denseArray.Get(index); }
+      Entity GetEntityAt(size_t index) const { return m_denseArray.GetKey(index); }
+
+      const Entity* Entities() const { return m_denseArray.Keys(); }
+      Comp* Data() { return m_denseArray.Data(); }
+
+      void Reserve(size_t capacity)
+      {
+         m_sparseSet.Reserve(capacity);
+         m_denseArray.Reserve(capacity);
       }
 
       size_t Size() const { return m_denseArray.Size(); }
 
+      // Change tracking is opt-in. Once enabled, the dense array is split into chunks of CHANGE_CHUNK_SIZE components and
+      // every chunk remembers the version at which a component in it was last added and last written through GetMutable.
+      // A reader calls AdvanceVersion when it runs and passes the returned version to ChangedSince/AddedSince next time.
+      void EnableChangeTracking()
+      {
+         if (m_trackChanges)
+            return;
+
+         m_trackChanges = true;
+         m_changedVersions.assign(ChunkCount(), m_version);
+         m_addedVersions.assign(ChunkCount(), m_version);
+      }
+
+      inline bool IsTrackingChanges() const { return m_trackChanges; }
+
+      // Closes the current version and returns it; writes made afterwards are stamped with a newer one.
+      uint32_t AdvanceVersion() { return m_version++; }
+      inline uint32_t Version() const { return m_version; }
+
+      void MarkChanged(size_t index)
+      {
+         if (m_trackChanges)
+            m_changedVersions[index / CHANGE_CHUNK_SIZE] = m_version;
+      }
+
+      inline size_t ChunkCount() const { return (Size() + CHANGE_CHUNK_SIZE - 1) / CHANGE_CHUNK_SIZE; }
+
+      // True if a component in the chunk was written or added after version. Always true while tracking is disabled.
+      bool ChangedSince(size_t chunk, uint32_t version) const { return !m_trackChanges || IsNewer(m_changedVersions[chunk], version); }
+      bool AddedSince(size_t chunk, uint32_t version) const { return !m_trackChanges || IsNewer(m_addedVersions[chunk], version); }
+
    private:
-      SparseSet<Entity, size_t> m_sparseSet;
-      DenseArray<size_t, Comp> m_denseArray;
+      inline void NotifyAdded(Entity entity)
+      {
+         if (m_observer.onAdded)
+            m_observer.onAdded(m_observer.context, entity);
+      }
+
+      inline void NotifyRemoving(Entity entity)
+      {
+         if (m_observer.onRemoving)
+            m_observer.onRemoving(m_observer.context, entity);
+      }
+
+      // Frees the entity's sparse slot if it is held by an earlier generation whose component was never removed. Returns
+      // false if the entity already has a component or a newer generation owns the slot, which a stale handle must not
+      // displace.
+      bool MakeRoomFor(Entity entity)
+      {
+         size_t index = m_sparseSet.Get(SparseKey(entity));
+         if (index == INVALID_INDEX)
+            return true;
+
+         const Entity occupant = m_denseArray.GetKey(index);
+         if (occupant == entity || !IsNewerGeneration(entity, occupant))
+            return false;
+
+         Remove(occupant);
+         return true;
+      }
+
+      // Generations wrap, so the nearer direction around the cycle decides which is newer.
+      static inline bool IsNewerGeneration(Entity lhs, Entity rhs)
+      {
+         const Symphony::Entity distance = (GetEntityGeneration(static_cast<Symphony::Entity>(lhs)) - GetEntityGeneration(static_cast<Symphony::Entity>(rhs))) & ENTITY_GENERATION_MASK;
+         return distance != 0 && distance <= ENTITY_GENERATION_MASK / 2;
+      }
+
+      // Compared with wraparound, so a version counter that overflows keeps ordering correctly.
+      static inline bool IsNewer(uint32_t lhs, uint32_t rhs) { return static_cast<int32_t>(lhs - rhs) > 0; }
+
+      void MarkAdded(size_t index)
+      {
+         if (!m_trackChanges)
+            return;
+
+         size_t chunk = index / CHANGE_CHUNK_SIZE;
+         if (chunk == m_changedVersions.size())
+         {
+            m_changedVersions.push_back(m_version);
+            m_addedVersions.push_back(m_version);
+         }
+
+         m_changedVersions[chunk] = m_version;
+         m_addedVersions[chunk] = m_version;
+      }
+
+      // A component relocated from one chunk to another carries its history with it; the destination keeps whichever is newer.
+      void MarkMoved(size_t from, size_t to)
+      {
+         if (!m_trackChanges)
+            return;
+
+         size_t source = from / CHANGE_CHUNK_SIZE;
+         size_t destination = to / CHANGE_CHUNK_SIZE;
+         if (source != destination)
+         {
+            if (IsNewer(m_changedVersions[source], m_changedVersions[destination]))
+               m_changedVersions[destination] = m_changedVersions[source];
+            if (IsNewer(m_addedVersions[source], m_addedVersions[destination]))
+               m_addedVersions[destination] = m_addedVersions[source];
+         }
+      }
+
+      void TrimChunkVersions()
+      {
+         if (!m_trackChanges)
+            return;
+
+         m_changedVersions.resize(ChunkCount());
+         m_addedVersions.resize(ChunkCount());
+      }
+
+      // The sparse side is keyed by the handle's index bits only, so recycled entities reuse their slot
+      // instead of spreading across new pages every generation.
+      static inline Entity SparseKey(Entity entity) { return static_cast<Entity>(GetEntityIndex(static_cast<Symphony::Entity>(entity))); }
+
+      SparseSetType m_sparseSet;
+      DenseArrayType m_denseArray;
+      std::vector<Entity> m_keyBatch;
+      std::vector<size_t> m_sourceBatch;
+      std::vector<std::pair<size_t, Entity>> m_replacements;
+      Observer m_observer;
+
+      bool m_trackChanges = false;
+      uint32_t m_version = 1;
+      std::vector<uint32_t> m_changedVersions;
+      std::vector<uint32_t> m_addedVersions;
    };
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "../Common.h"
+#include "../Core/Memory.h"
+#include "../ECS/Defines.h"
+
+namespace Symphony
+{
+   // Hands out fixed-size blocks carved from large pages. Freed blocks go onto an intrusive free list and are reused
+   // before any new page is requested, so once a workload reaches its peak block count it never touches the heap again.
+   // Pages are only returned when the pool is destroyed.
+   class FixedPool
+   {
+   public:
+      static constexpr size_t PAGE_SIZE = 64 * 1024;
+
+      FixedPool(size_t blockSize, size_t blockAlignment) :
+         m_blockAlignment(std::max(blockAlignment, alignof(FreeBlock))),
+         m_blockSize(AlignUp(std::max(blockSize, sizeof(FreeBlock)), m_blockAlignment)),
+         m_blocksPerPage(std::max<size_t>(PAGE_SIZE / m_blockSize, 1)),
+         m_freeList(nullptr),
+         m_allocated(0)
+      {}
+
+      FixedPool(const FixedPool&) = delete;
+      FixedPool& operator=(const FixedPool&) = delete;
+
+      ~FixedPool()
+      {
+         for (std::byte* page : m_pages)
+            Cypher::Memory::Deallocate(page, PageBytes(), m_blockAlignment, Cypher::MemoryArena::ECS);
+      }
+
+      void* Allocate()
+      {
+         std::lock_guard<std::mutex> lock(m_lock);
+         if (!m_freeList)
+            Grow();
+
+         FreeBlock* block = m_freeList;
+         m_freeList = block->next;
+         ++m_allocated;
+         return block;
+      }
+
+      void Deallocate(void* pointer)
+      {
+         if (!pointer)
+            return;
+
+         std::lock_guard<std::mutex> lock(m_lock);
+         FreeBlock* block = static_cast<FreeBlock*>(pointer);
+         block->next = m_freeList;
+         m_freeList = block;
+         --m_allocated;
+      }
+
+      inline size_t BlockSize() const { return m_blockSize; }
+      inline size_t BlocksAllocated() const { return m_allocated; }
+      inline size_t Capacity() const { return m_pages.size() * m_blocksPerPage; }
+
+   private:
+      struct FreeBlock
+      {
+         FreeBlock* next;
+      };
+
+      static constexpr size_t AlignUp(size_t value, size_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+      inline size_t PageBytes() const { return m_blockSize * m_blocksPerPage; }
+
+      void Grow()
+      {
+         std::byte* page = static_cast<std::byte*>(Cypher::Memory::Allocate(PageBytes(), m_blockAlignment, Cypher::MemoryArena::ECS));
+         m_pages.push_back(page);
+
+         // Thread the page onto the free list back to front so blocks are handed out in address order
+         for (size_t i = m_blocksPerPage; i-- > 0;)
+         {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(page + i * m_blockSize);
+            block->next = m_freeList;
+            m_freeList = block;
+         }
+      }
+
+      const size_t m_blockAlignment;
+      const size_t m_blockSize;
+      const size_t m_blocksPerPage;
+
+      std::mutex m_lock;
+      FreeBlock* m_freeList;
+      std::vector<std::byte*> m_pages;
+      size_t m_allocated;
+   };
+
+   // Allocator backed by one process-wide FixedPool per value type. Single-object allocations come from the pool;
+   // array allocations, which a fixed block size cannot serve, go straight to the ECS memory arena.
+   template<typename T>
+   class PoolAllocator
+   {
+   public:
+      using value_type = T;
+
+      PoolAllocator() noexcept = default;
+
+      template<typename U>
+      PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+      [[nodiscard]] T* allocate(size_t n)
+      {
+         if (n == 1)
+            return static_cast<T*>(GetPool().Allocate());
+         return static_cast<T*>(Cypher::Memory::Allocate(n * sizeof(T), alignof(T), Cypher::MemoryArena::ECS));
+      }
+
+      void deallocate(T* pointer, size_t n)
+      {
+         if (n == 1)
+            GetPool().Deallocate(pointer);
+         else
+            Cypher::Memory::Deallocate(pointer, n * sizeof(T), alignof(T), Cypher::MemoryArena::ECS);
+      }
+
+      // Never destroyed, so containers with static storage duration can still release blocks during shutdown.
+      static FixedPool& GetPool()
+      {
+         static FixedPool* pool = new FixedPool(sizeof(T), alignof(T));
+         return *pool;
+      }
+
+      template<typename U>
+      bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+   };
+
+   static_assert(Allocator<PoolAllocator<int>>);
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "../Common.h"
+#include "../Core/Memory.h"
+#include "../ECS/Defines.h"
+
+namespace Symphony
+{
+   // Small-object allocator with a cache per thread. Requests are rounded up to a power-of-two size class; each thread
+   // keeps one free list per class and carves new blocks from its own slab, so the common path takes no lock and shares
+   // no cache lines with other threads. Slabs are taken from a process-wide list under a lock and never returned, and a
+   // block freed on another thread simply joins that thread's free list.
+   class SlabHeap
+   {
+   public:
+      static constexpr size_t SLAB_SIZE = 64 * 1024;
+      static constexpr size_t MIN_CLASS_SHIFT = 4;
+      static constexpr size_t MAX_CLASS_SHIFT = 12;
+      static constexpr size_t CLASS_COUNT = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+      static constexpr size_t MAX_SIZE = size_t(1) << MAX_CLASS_SHIFT;
+
+      // Requests larger than MAX_SIZE or aligned past their size class go straight to the ECS memory arena.
+      static bool IsSlabSize(size_t size, size_t alignment) { return size <= MAX_SIZE && alignment <= ClassSize(ClassOf(size)); }
+
+      static void* Allocate(size_t size, size_t alignment)
+      {
+         if (!IsSlabSize(size, alignment))
+            return Cypher::Memory::Allocate(size, alignment, Cypher::MemoryArena::ECS);
+
+         return GetCache().Allocate(ClassOf(size));
+      }
+
+      static void Deallocate(void* pointer, size_t size, size_t alignment)
+      {
+         if (!pointer)
+            return;
+
+         if (!IsSlabSize(size, alignment))
+            Cypher::Memory::Deallocate(pointer, size, alignment, Cypher::MemoryArena::ECS);
+         else
+            GetCache().Deallocate(pointer, ClassOf(size));
+      }
+
+   private:
+      struct FreeBlock
+      {
+         FreeBlock* next;
+      };
+
+      static constexpr size_t ClassOf(size_t size)
+      {
+         size_t shift = size <= (size_t(1) << MIN_CLASS_SHIFT) ? MIN_CLASS_SHIFT : std::bit_width(size - 1);
+         return shift - MIN_CLASS_SHIFT;
+      }
+
+      static constexpr size_t ClassSize(size_t sizeClass) { return size_t(1) << (sizeClass + MIN_CLASS_SHIFT); }
+
+      // Slabs outlive every thread cache, since blocks may still be in use after the thread that carved them exits.
+      static std::byte* AcquireSlab()
+      {
+         static std::mutex lock;
+         static std::vector<std::byte*>* slabs = new std::vector<std::byte*>();
+
+         std::byte* slab = static_cast<std::byte*>(Cypher::Memory::Allocate(SLAB_SIZE, MAX_SIZE, Cypher::MemoryArena::ECS));
+         std::lock_guard<std::mutex> guard(lock);
+         slabs->push_back(slab);
+         return slab;
+      }
+
+      class ThreadCache
+      {
+      public:
+         void* Allocate(size_t sizeClass)
+         {
+            FreeBlock*& head = m_freeLists[sizeClass];
+            if (head)
+            {
+               FreeBlock* block = head;
+               head = block->next;
+               return block;
+            }
+
+            const size_t size = ClassSize(sizeClass);
+            if (!m_slab || m_slabOffset + size > SLAB_SIZE)
+            {
+               m_slab = AcquireSlab();
+               m_slabOffset = 0;
+            }
+
+            // Classes are powers of two and slabs are aligned to the largest one, so aligning the offset aligns the block
+            m_slabOffset = (m_slabOffset + size - 1) & ~(size - 1);
+            void* block = m_slab + m_slabOffset;
+            m_slabOffset += size;
+            return block;
+         }
+
+         void Deallocate(void* pointer, size_t sizeClass)
+         {
+            FreeBlock* block = static_cast<FreeBlock*>(pointer);
+            block->next = m_freeLists[sizeClass];
+            m_freeLists[sizeClass] = block;
+         }
+
+      private:
+         std::array<FreeBlock*, CLASS_COUNT> m_freeLists = {};
+         std::byte* m_slab = nullptr;
+         size_t m_slabOffset = 0;
+      };
+
+      static ThreadCache& GetCache()
+      {
+         thread_local ThreadCache cache;
+         return cache;
+      }
+   };
+
+   template<typename T>
+   class SlabAllocator
+   {
+   public:
+      using value_type = T;
+
+      SlabAllocator() noexcept = default;
+
+      template<typename U>
+      SlabAllocator(const SlabAllocator<U>&) noexcept {}
+
+      [[nodiscard]] T* allocate(size_t n) { return static_cast<T*>(SlabHeap::Allocate(n * sizeof(T), alignof(T))); }
+      void deallocate(T* pointer, size_t n) { SlabHeap::Deallocate(pointer, n * sizeof(T), alignof(T)); }
+
+      template<typename U>
+      bool operator==(const SlabAllocator<U>&) const noexcept { return true; }
+   };
+
+   static_assert(Allocator<SlabAllocator<int>>);
+}
@@ -3,189 +3,59 @@
 #include <cstring>
 
 #include "../Common.h"
+#include "../ECS/Defines.h"
+#include "PoolAllocator.h"
 
 #include <algorithm>
-#include <array>
-#include <map>
+#include <iterator>
+#include <limits>
 #include <memory>
-#include <optional>
+#include <span>
 #include <type_traits>
 #include <utility>
+#include <vector>
+#include <xmmintrin.h>
 
 namespace Symphony
 {
-   class Bucket;
-
-   template<typename Key = Entity, typename Value = size_t, typename KeyAlloc = std::allocator<Key>, typename BucketAlloc = std::allocator<Bucket>>
+   template<typename Key = Entity, typename Value = size_t, typename KeyAlloc = PoolAllocator<Key>, typename BucketAlloc = PoolAllocator<Value>>
    requires Allocator<KeyAlloc> && Allocator<BucketAlloc>
    class SparseSet
    {
       static_assert(std::is_arithmetic_v<Key>, "SparseSet: Key type must be a primitive type.");
       static_assert(std::is_arithmetic_v<Value>, "SparseSet: Value type must be a primitive type.");
 
+   public:
       static constexpr size_t SPARSE_BUCKET_SHIFT = 10;
       static constexpr size_t SPARSE_BUCKET_SIZE = 1 << SPARSE_BUCKET_SHIFT;
 
-      class Bucket
-      {
-      public:
-         Bucket() : m_size(0)
-         {
-            size_t alignment = std::max(alignof(Key), alignof(Value));
-            
-            m_data = static_cast<char*>(_aligned_malloc(SPARSE_BUCKET_SIZE * (sizeof(Key) + sizeof(Value)), alignment));
-            m_keys = reinterpret_cast<Key*>(m_data);
-            m_values = reinterpret_cast<Value*>(m_data + SPARSE_BUCKET_SIZE * sizeof(Key));
-         }
-
-         ~Bucket()
-         {
-            _aligned_free(m_data);
-            m_keys = nullptr;
-            m_values = nullptr;
-         }
-
-         inline void Deallocate(BucketAlloc* allocator)
-         {
-            if (m_keys || m_values) [[unlikely]]
-               return;
-
-            if (allocator) [[likely]]
-               allocator->deallocate(this);
-         }
-
-         void* operator new(size_t size, BucketAlloc& pool) { return pool.allocate(size); }
-
-         void operator delete(void* p, BucketAlloc& pool) { pool.deallocate(p); }
-
-         inline bool Contains(Key key) const { return std::binary_search(m_keys, m_keys + m_size, key); }
-
-         [[nodiscard]] inline std::optional<Value> Value(Key key) const
-         {
-            auto it = std::lower_bound(m_keys, m_keys + m_size, key);
-            if (it && (it != m_keys + m_size && *it == key))
-               return m_values[std::distance(m_keys, it)];
-            return std::nullopt;
-         }
-
-         inline bool Insert(Key key, Value value)
-         {
-            if (m_size >= SPARSE_BUCKET_SIZE) [[unlikely]]
-               return false;
-
-            auto it = std::lower_bound(m_keys, m_keys + m_size, key);
-            if (!it)
-               return false;
-            auto index = std::distance(m_keys, it);
-
-            // Shift keys and values to make space for the new k/v pair
-            std::memmove(&m_keys[index + 1], &m_keys[index], (m_size - index) * sizeof(Key));
-            std::memmove(&m_values[index + 1], &m_values[index], (m_size - index) * sizeof(Value));
-
-            m_keys[index] = key;
-            m_values[index] = value;
-            ++m_size;
-            return true;
-         }
-
-         inline void Remove(Key key)
-         {
-            auto it = std::lower_bound(m_keys, m_keys + m_size, key);
-            if (!it || it == m_keys + m_size || *it != key)
-               return;
-
-            auto index = std::distance(m_keys, it);
-
-            // Shift keys and values to cover up the gap left by the removed k/v pair
-            std::memmove(&m_keys[index], &m_keys[index + 1], (m_size - index - 1) * sizeof(Key));
-            std::memmove(&m_values[index], &m_values[index + 1], (m_size - index - 1) * sizeof(Value));
-
-            --m_size;
-         }
-
-         void Distribute(Bucket& other)
-         {
-            if (other == *this)
-               return;
-
-            size_t mid = m_size >> 1;
-
-            // Move the latter half of this bucket's keys & values to the beginning of other
-            std::move(m_keys + mid, m_keys + m_size, other.m_keys);
-            std::move(m_values + mid, m_values + m_size, other.m_values);
-
-            other.m_size = m_size - mid;
-            m_size = mid;
-         }
-
-         void Merge(Bucket& other)
-         {
-            if (other == *this)
-               return;
-
-            // Move all keys & values from other to the end of this bucket
-            std::move(other.m_keys, other.m_keys + other.m_size, m_keys + m_size);
-            std::move(other.m_values, other.m_values + other.m_size, m_values + m_size);
-            m_size += other.m_size;
-         }
+      static constexpr Value INVALID_VALUE = std::numeric_limits<Value>::max();
 
-         void Rebalance(Bucket& other)
-         {
-            if (other == *this)
-               return;
-
-            size_t totalSize = m_size + other.m_size;
-            size_t targetSize = totalSize >> 1;
-            size_t entitiesToMove = 0;
-
-            if (m_size < targetSize)
-            {
-               // Move entities from other to this bucket
-               entitiesToMove = targetSize - m_size;
-
-               // Move entities from the beginning of other to the end of this bucket
-               std::move(other.m_keys, other.m_keys + entitiesToMove, m_keys + m_size);
-               std::move(other.m_values, other.m_values + entitiesToMove, m_values + m_size);
-
-               // Shift the entities in other to fill the gap
-               std::move(other.m_keys + entitiesToMove, other.m_keys + other.m_size, other.m_keys);
-               std::move(other.m_values + entitiesToMove, other.m_values + other.m_size, other.m_values);
-            }
-            else
-            {
-               // Move entities from this bucket to other
-               entitiesToMove = m_size - targetSize;
-
-               // Shift the entities in other to make room for incoming entities
-               std::move_backward(other.m_keys, other.m_keys + other.m_size, other.m_keys + other.m_size + entitiesToMove);
-               std::move_backward(other.m_values, other.m_values + other.m_size, other.m_values + other.m_size + entitiesToMove);
-
-               // Move entities from the end of this bucket to the beginning of other
-               std::move(m_keys + targetSize, m_keys + m_size, other.m_keys);
-               std::move(m_values + targetSize, m_values + m_size, other.m_values);
-            }
+      // Marks dense entries that RemoveRange is about to drop. The largest key cannot be inserted.
+      static constexpr Key TOMBSTONE_KEY = std::numeric_limits<Key>::max();
 
-            m_size = targetSize;
-            other.m_size = totalSize - targetSize;
-         }
-
-         inline size_t Size() const { return m_size; }
+   private:
+      // A fixed-size page of the sparse array. Keys are mapped to a page by their high bits and
+      // to a slot within it by their low bits, so lookups never search.
+      struct Bucket
+      {
+         Value values[SPARSE_BUCKET_SIZE];
 
-      private:
-         char* m_data;
-         Key* m_keys;
-         Value* m_values;
-         size_t m_size;
+         inline void Reset() { std::fill_n(values, SPARSE_BUCKET_SIZE, INVALID_VALUE); }
       };
 
-      using EntityAllocatorType = std::allocator_traits<KeyAlloc>::template rebind_alloc<Key>;
-      using BucketAllocatorType = std::allocator_traits<BucketAlloc>::template rebind_alloc<Bucket>;
+      using EntityAllocatorType = RebindAlloc<KeyAlloc, Key>;
+      using BucketAllocatorType = RebindAlloc<BucketAlloc, Bucket>;
+      using BucketTable = std::vector<Bucket*, RebindAlloc<BucketAlloc, Bucket*>>;
+
+      // Keys RemoveRange looks ahead when prefetching slots, enough to cover a miss to memory
+      static constexpr size_t REMOVE_PREFETCH_DISTANCE = 8;
 
    public:
       class Iterator
       {
       public:
-         using iterator_category = std::bidirectional_iterator_tag;
+         using iterator_category = std::random_access_iterator_tag;
          using value_type = std::pair<Key, Value>;
          using difference_type = std::ptrdiff_t;
          using pointer = value_type*;
@@ -194,7 +64,7 @@ namespace Symphony
          bool operator==(const Iterator& rhs) const { return m_densePtr == rhs.m_densePtr; }
          bool operator!=(const Iterator& rhs) const { return m_densePtr != rhs.m_densePtr; }
 
-         value_type operator*() const { return { *m_densePtr, *m_sparsePtr }; }
+         value_type operator*() const { return { *m_densePtr, m_set->Get(*m_densePtr) }; }
          pointer operator->() const
          {
             thread_local value_type tempValue;
@@ -205,7 +75,6 @@ namespace Symphony
          Iterator& operator++()
          {
             ++m_densePtr;
-            ++m_sparsePtr;
             return *this;
          }
 
@@ -219,7 +88,6 @@ namespace Symphony
          Iterator& operator--()
          {
             --m_densePtr;
-            --m_sparsePtr;
             return *this;
          }
 
@@ -230,25 +98,22 @@ namespace Symphony
             return tmp;
          }
 
-         value_type operator[](difference_type n) { return { *(m_densePtr + n), *(m_sparsePtr + n) }; }
-         const value_type operator[](difference_type n) const { return { *(m_densePtr + n), *(m_sparsePtr + n) }; }
+         value_type operator[](difference_type n) const { return { *(m_densePtr + n), m_set->Get(*(m_densePtr + n)) }; }
 
-         Iterator operator+(difference_type n) const { return Iterator(m_densePtr + n, m_sparsePtr + n); }
-         Iterator operator-(difference_type n) const { return Iterator(m_densePtr - n, m_sparsePtr - n); }
+         Iterator operator+(difference_type n) const { return Iterator(m_set, m_densePtr + n); }
+         Iterator operator-(difference_type n) const { return Iterator(m_set, m_densePtr - n); }
 
          difference_type operator-(const Iterator& rhs) const { return m_densePtr - rhs.m_densePtr; }
 
          Iterator& operator+=(difference_type n)
          {
             m_densePtr += n;
-            m_sparsePtr += n;
             return *this;
          }
 
          Iterator& operator-=(difference_type n)
          {
             m_densePtr -= n;
-            m_sparsePtr -= n;
             return *this;
          }
 
@@ -258,195 +123,289 @@ namespace Symphony
          bool operator>=(const Iterator& rhs) const { return m_densePtr >= rhs.m_densePtr; }
 
       private:
-         Iterator(Key* densePtr, Value* sparsePtr) :
-            m_densePtr(densePtr),
-            m_sparsePtr(sparsePtr)
+         Iterator(const SparseSet* set, Key* densePtr) :
+            m_set(set),
+            m_densePtr(densePtr)
          {}
 
          friend class SparseSet;
 
+         const SparseSet* m_set;
          Key* m_densePtr;
-         Value* m_sparsePtr;
       };
 
       using ConstIterator = const Iterator;
 
-      using InvalidValue = std::numeric_limits<Value>::value;
-
       explicit SparseSet(size_t initialCapacity = SPARSE_BUCKET_SIZE, float growFactor = 2) :
          m_entityAllocator(KeyAlloc()),
-         m_bucketAllocator(BucketAlloc),
+         m_bucketAllocator(BucketAlloc()),
          m_size(0),
-         m_capacity(initialCapacity),
+         m_capacity(std::max<size_t>(initialCapacity, 1)),
          m_growFactor(growFactor)
       {
          m_dense = m_entityAllocator.allocate(m_capacity);
       }
 
+      SparseSet(const SparseSet&) = delete;
+      SparseSet& operator=(const SparseSet&) = delete;
+
       ~SparseSet()
       {
-         for (auto& [_, bucket] : m_sparse)
-         {
-            if (bucket)
-            {
-               bucket->~Bucket();
-               bucket->Deallocate(&m_bucketAllocator);
-            }
-         }
-         m_sparse.clear();
+         ReleaseBuckets();
          m_entityAllocator.deallocate(m_dense, m_capacity);
       }
 
-      Value operator[](Key key) { return Get(key); }
-      const Value operator[](Key key) const { return Get(key); }
+      Value operator[](Key key) const { return Get(key); }
 
       size_t Insert(Key entity, Value value)
       {
+         Assert(entity != TOMBSTONE_KEY);
+
          auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
          Bucket* bucket = GetOrCreateBucket(bucketIndex);
-         if (!bucket)
+         if (!bucket) [[unlikely]]
             return m_size;
-         if (bucket->Contains(offset))
-            return bucket->Value(offset).value_or(-1);
 
-         // Create new bucket and distribute selected buckets elements
-         if (bucket->Size() >= SPARSE_BUCKET_SIZE)
-         {
-            Bucket* newBucket = GetOrCreateBucket(bucketIndex + 1);
-            if (newBucket)
-               bucket->Distribute(*newBucket);
-         }
+         Value& slot = bucket->values[offset];
+         if (slot != INVALID_VALUE)
+            return slot;
 
          if (m_size == m_capacity)
-            Resize(m_capacity * m_growFactor);
+            Resize(static_cast<size_t>(m_capacity * m_growFactor) + 1);
 
          m_dense[m_size] = entity;
-         bucket->Insert(offset, value);
+         slot = value;
 
          return m_size++;
       }
 
-      [[nodiscard]] Value Get(Key entity)
+      [[nodiscard]] Value Get(Key entity) const
       {
-         auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
-         auto bucketIt = m_sparse.find(bucketIndex);
-         if (bucketIt && bucketIt != m_sparse.end())
-            return bucketIt->second->Value(offset);
-         return InvalidValue;
-      }
-
-      [[nodiscard]] const Value Get(Key entity) const
-      {
-         auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
-         auto bucketIt = m_sparse.find(bucketIndex);
-         if (bucketIt && bucketIt != m_sparse.end())
-            return bucketIt->second->Value(offset);
-         return InvalidValue;
+         const Value* slot = Find(entity);
+         return slot ? *slot : INVALID_VALUE;
       }
 
       void Remove(Key entity)
       {
-         auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
-         Bucket* bucket = GetOrCreateBucket(bucketIndex);
-         if (!bucket)
-            return;
-
-         auto removedIndexOpt = bucket->Value(offset);
-         if (removedIndexOpt ==  std::nullopt)
+         Value* slot = Find(entity);
+         if (!slot || *slot == INVALID_VALUE)
             return;
 
-         Value removedIndex = removedIndexOpt.value();
+         Value removedIndex = *slot;
 
          // If target entity is not last in the dense array, swap it with the last entity to maintain dense packing
          if (removedIndex != m_size - 1)
          {
             Key last = m_dense[m_size - 1];
             m_dense[removedIndex] = last;
+            *Find(last) = removedIndex;
+         }
 
-            auto [lastBucketIndex, lastOffset] = GetBucketIndexAndOffset(last);
-            Bucket* lastBucket = m_sparse[lastBucketIndex];
-            if (lastBucket)
+         *slot = INVALID_VALUE;
+         --m_size;
+      }
+
+      // Inserts every key of the batch that is not yet present, giving each its dense position as value. The page table
+      // and the dense array grow at most once for the whole batch, and each key is then a direct slot write. A key
+      // already present, including one repeated in the batch, is skipped and reported as onPresent(i, value) for
+      // keys[i]. The inserted keys are appended to Data() in batch order. Returns the number of keys inserted.
+      template<typename OnPresent>
+      size_t InsertRange(std::span<const Key> keys, OnPresent&& onPresent)
+      {
+         if (keys.empty())
+            return 0;
+
+         size_t required = m_size + keys.size();
+         if (required > m_capacity)
+            Resize(std::max(required, static_cast<size_t>(m_capacity * m_growFactor) + 1));
+
+         size_t lastBucket = GetBucketIndexAndOffset(*std::max_element(keys.begin(), keys.end())).first;
+         if (lastBucket >= m_sparse.size())
+            m_sparse.resize(lastBucket + 1, nullptr);
+
+         // The table is sized for the whole batch, so its pages are looked up directly, and the size is kept in a
+         // local the slot writes cannot alias
+         Bucket** table = m_sparse.data();
+         Key* dense = m_dense;
+         const size_t oldSize = m_size;
+         size_t size = oldSize;
+         for (size_t i = 0; i < keys.size(); ++i)
+         {
+            Assert(keys[i] != TOMBSTONE_KEY);
+
+            auto [bucketIndex, offset] = GetBucketIndexAndOffset(keys[i]);
+            Bucket* bucket = table[bucketIndex] ? table[bucketIndex] : GetOrCreateBucket(bucketIndex);
+            if (!bucket) [[unlikely]]
+               break;
+
+            Value& slot = bucket->values[offset];
+            if (slot != INVALID_VALUE)
             {
-               lastBucket->Remove(lastOffset);
-               lastBucket->Insert(lastOffset, removedIndex);
+               onPresent(i, slot);
+               continue;
             }
+
+            slot = static_cast<Value>(size);
+            dense[size++] = keys[i];
          }
 
-         bucket->Remove(offset);
+         m_size = size;
+         return size - oldSize;
+      }
+
+      size_t InsertRange(std::span<const Key> keys) { return InsertRange(keys, [](size_t, Value) {}); }
 
-         // If a bucket is underfilled, check if it should be merged or rebalanced with the next bucket
-         if (bucket->Size() < SPARSE_BUCKET_SIZE >> 1)
+      // Removes every key of the batch that is present and that accept(i, value) lets go for keys[i], moving each
+      // surviving entry at most once. Only the last keys.size() entries can end up past the new size. A hole below that
+      // band is filled at once with the last live entry, as Remove would. A hole inside it is overwritten with
+      // TOMBSTONE_KEY, skipped when live entries are taken from the end, and filled by a scan of the band afterwards,
+      // which moves nothing when the batch is the tail of the set. onMove(from, to) is called for every entry
+      // relocated, so an owner can mirror the move. Returns the number of keys removed.
+      template<typename Accept, typename OnMove>
+      size_t RemoveRange(std::span<const Key> keys, Accept&& accept, OnMove&& onMove)
+      {
+         // Kept in locals, as the slot writes could otherwise alias them
+         Bucket* const* table = m_sparse.data();
+         const size_t tableSize = m_sparse.size();
+         Key* dense = m_dense;
+         const size_t band = m_size - std::min(m_size, keys.size());
+         size_t tail = m_size;
+         size_t removed = 0;
+
+         // At least band entries stay live, so the last live entry always lies above a hole below band
+         auto fill = [&](size_t hole)
+         {
+            do
+               --tail;
+            while (dense[tail] == TOMBSTONE_KEY);
+
+            const Key moved = dense[tail];
+            dense[hole] = moved;
+            auto [bucketIndex, offset] = GetBucketIndexAndOffset(moved);
+            table[bucketIndex]->values[offset] = static_cast<Value>(hole);
+            onMove(tail, hole);
+         };
+
+         for (size_t i = 0; i < keys.size(); ++i)
          {
-            auto nextBucketIter = m_sparse.find(bucketIndex + 1);
-            if (nextBucketIter && nextBucketIter != m_sparse.end())
+            // The whole batch is known up front, so the slots of keys further on are requested while this one is
+            // handled; scattered keys would otherwise wait on one cache miss after another.
+            if (i + REMOVE_PREFETCH_DISTANCE < keys.size())
             {
-               Bucket* nextBucket = nextBucketIter->second;
-               if (nextBucket)
-               {
-                  // If the combined size of the current and next bucket is within limits, merge them
-                  if (bucket->Size() + nextBucket->Size() <= SPARSE_BUCKET_SIZE)
-                  {
-                     bucket->Merge(*nextBucket);
-                     nextBucket->~Bucket();
-                     nextBucket->Deallocate(m_bucketAllocator);
-                     m_sparse.erase(nextBucketIter);
-                  } // Otherwise, rebalance
-                  else
-                  {
-                     bucket->Rebalance(*nextBucket);
-                  }
-               }
+               auto [aheadBucket, aheadOffset] = GetBucketIndexAndOffset(keys[i + REMOVE_PREFETCH_DISTANCE]);
+               if (aheadBucket < tableSize && table[aheadBucket])
+                  _mm_prefetch(reinterpret_cast<const char*>(&table[aheadBucket]->values[aheadOffset]), _MM_HINT_T0);
             }
+
+            auto [bucketIndex, offset] = GetBucketIndexAndOffset(keys[i]);
+            Bucket* bucket = bucketIndex < tableSize ? table[bucketIndex] : nullptr;
+            if (!bucket)
+               continue;
+
+            Value& slot = bucket->values[offset];
+            if (slot == INVALID_VALUE || !accept(i, slot))
+               continue;
+
+            const size_t hole = static_cast<size_t>(slot);
+            slot = INVALID_VALUE;
+            ++removed;
+            if (hole < band)
+               fill(hole);
+            else
+               dense[hole] = TOMBSTONE_KEY;
          }
-         --m_size;
+
+         const size_t newSize = m_size - removed;
+         for (size_t hole = band; hole < newSize; ++hole)
+         {
+            if (dense[hole] == TOMBSTONE_KEY)
+               fill(hole);
+         }
+
+         m_size = newSize;
+         return removed;
+      }
+
+      size_t RemoveRange(std::span<const Key> keys) { return RemoveRange(keys, [](size_t, Value) { return true; }, [](size_t, size_t) {}); }
+
+      // Exchanges the dense positions of two present keys, and with them their values.
+      void Swap(Key lhs, Key rhs)
+      {
+         Value* lhsSlot = Find(lhs);
+         Value* rhsSlot = Find(rhs);
+         Assert(lhsSlot && rhsSlot && *lhsSlot != INVALID_VALUE && *rhsSlot != INVALID_VALUE);
+
+         std::swap(m_dense[*lhsSlot], m_dense[*rhsSlot]);
+         std::swap(*lhsSlot, *rhsSlot);
       }
 
       bool Contains(Key entity) const
       {
-         auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
-         auto bucketIt = m_sparse.find(bucketIndex);
-         
-         return bucketIt && bucketIt != m_sparse.end() && bucketIt->second->Contains(offset);
+         const Value* slot = Find(entity);
+         return slot && *slot != INVALID_VALUE;
       }
 
       void Clear()
       {
-         for (auto& [_, bucket] : m_sparse)
-         {
-            if (bucket)
-            {
-               bucket->~Bucket();
-               bucket->Deallocate(m_bucketAllocator);
-            }
-         }
-         m_sparse.clear();
+         ReleaseBuckets();
          m_size = 0;
       }
 
+      void Reserve(size_t capacity) { Resize(capacity); }
+
       inline size_t Size() const { return m_size; }
 
       inline size_t Capacity() const { return m_capacity; }
 
-      Iterator begin() { return Iterator(m_dense, m_sparse); }
-      Iterator end() { return Iterator(m_dense + m_size, m_sparse + m_size); }
+      inline const Key* Data() const { return m_dense; }
 
-      ConstIterator cbegin() const { return Iterator(m_dense, m_sparse); }
-      ConstIterator cend() const { return Iterator(m_dense + m_size, m_sparse + m_size); }
+      Iterator begin() { return Iterator(this, m_dense); }
+      Iterator end() { return Iterator(this, m_dense + m_size); }
+
+      ConstIterator cbegin() const { return Iterator(this, m_dense); }
+      ConstIterator cend() const { return Iterator(this, m_dense + m_size); }
 
    private:
+      [[nodiscard]] inline Value* Find(Key entity) const
+      {
+         auto [bucketIndex, offset] = GetBucketIndexAndOffset(entity);
+         if (bucketIndex >= m_sparse.size())
+            return nullptr;
+
+         Bucket* bucket = m_sparse[bucketIndex];
+         return bucket ? &bucket->values[offset] : nullptr;
+      }
+
       [[nodiscard]] Bucket* GetOrCreateBucket(size_t bucketIndex)
       {
-         auto [it, created] = m_sparse.try_emplace(bucketIndex, nullptr);
-         if (created)
-            it->second = new(m_bucketAllocator) Bucket();
-         return it->second;
+         if (bucketIndex >= m_sparse.size())
+            m_sparse.resize(bucketIndex + 1, nullptr);
+
+         Bucket*& bucket = m_sparse[bucketIndex];
+         if (!bucket)
+         {
+            bucket = m_bucketAllocator.allocate(1);
+            if (bucket)
+               bucket->Reset();
+         }
+         return bucket;
+      }
+
+      void ReleaseBuckets()
+      {
+         for (Bucket* bucket : m_sparse)
+         {
+            if (bucket)
+               m_bucketAllocator.deallocate(bucket, 1);
+         }
+         m_sparse.clear();
       }
 
-      [[nodiscard]] inline std::pair<size_t, size_t> GetBucketIndexAndOffset(Key entity) const { return { entity >> SPARSE_BUCKET_SHIFT, entity & (SPARSE_BUCKET_SIZE - 1) }; }
+      [[nodiscard]] static inline std::pair<size_t, size_t> GetBucketIndexAndOffset(Key entity) { return { static_cast<size_t>(entity) >> SPARSE_BUCKET_SHIFT, static_cast<size_t>(entity) & (SPARSE_BUCKET_SIZE - 1) }; }
 
       inline void Resize(size_t newCapacity)
       {
-         if (newCapacity < m_capacity) [[unlikely]]
+         if (newCapacity <= m_capacity) [[unlikely]]
             return;
 
          Key* newDense = m_entityAllocator.allocate(newCapacity);
@@ -463,7 +422,7 @@ namespace Symphony
       BucketAllocatorType m_bucketAllocator;
 
       Key* m_dense;
-      std::map<Value, Bucket*> m_sparse;
+      BucketTable m_sparse;
       size_t m_size;
       size_t m_capacity;
       float m_growFactor;
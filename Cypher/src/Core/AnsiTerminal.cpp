@@ -0,0 +1,482 @@
+#include "AnsiTerminal.h"
+
+#ifndef _WIN32
+
+#include <cerrno>
+#include <charconv>
+#include <csignal>
+#include <cstring>
+
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "Core/KeyCode.h"
+#include "Util/StringUtil.h"
+
+namespace
+{
+   volatile std::sig_atomic_t s_resized = 0;
+
+   void OnResize(int)
+   {
+      s_resized = 1;
+   }
+
+   constexpr uint8_t Key(Cypher::KeyCode key) { return static_cast<uint8_t>(key); }
+
+   // Alternate screen, hidden cursor, no autowrap, all mouse motion in SGR encoding
+   constexpr const char* ENTER_SEQUENCE = "\x1b[?1049h\x1b[?25l\x1b[?7l\x1b[?1003h\x1b[?1006h";
+   constexpr const char* LEAVE_SEQUENCE = "\x1b[0m\x1b[?1006l\x1b[?1003l\x1b[?7h\x1b[?25h\x1b[?1049l";
+
+   // Input bytes kept waiting for the rest of an escape sequence before they are given up on
+   constexpr size_t MAX_PENDING_INPUT = 64;
+}
+
+Cypher::AnsiTerminal::AnsiTerminal() :
+   m_open(false),
+   m_fullRedraw(true),
+   m_width(0),
+   m_height(0),
+   m_restoreMode(),
+   m_cursorX(-1),
+   m_cursorY(-1),
+   m_attributes(-1),
+   m_runCount(0)
+{
+   m_input.reserve(256);
+}
+
+Cypher::AnsiTerminal::~AnsiTerminal()
+{
+   Close();
+}
+
+bool Cypher::AnsiTerminal::Open(SHORT width, SHORT height)
+{
+   if (m_open)
+      return true;
+   if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO))
+      return false;
+
+   winsize size = {};
+   if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && (size.ws_col < width || size.ws_row < height))
+      return false;
+
+   if (tcgetattr(STDIN_FILENO, &m_restoreMode) != 0)
+      return false;
+
+   // Raw input that never blocks a read. ISIG stays on so Ctrl+C still raises SIGINT.
+   termios raw = m_restoreMode;
+   raw.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+   raw.c_oflag &= ~OPOST;
+   raw.c_cflag |= CS8;
+   raw.c_lflag &= ~(ECHO | ICANON | IEXTEN);
+   raw.c_cc[VMIN] = 0;
+   raw.c_cc[VTIME] = 0;
+   if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) != 0)
+      return false;
+
+   struct sigaction action = {};
+   action.sa_handler = OnResize;
+   sigemptyset(&action.sa_mask);
+   sigaction(SIGWINCH, &action, nullptr);
+
+   m_width = width;
+   m_height = height;
+   m_previous.assign(static_cast<size_t>(width) * height, CHAR_INFO{});
+   m_output.reserve(static_cast<size_t>(width) * height * 16);
+   m_fullRedraw = true;
+   m_open = true;
+
+   m_output += ENTER_SEQUENCE;
+   Flush();
+   return true;
+}
+
+void Cypher::AnsiTerminal::Close()
+{
+   if (!m_open)
+      return;
+
+   m_output.clear();
+   m_output += LEAVE_SEQUENCE;
+   Flush();
+
+   tcsetattr(STDIN_FILENO, TCSAFLUSH, &m_restoreMode);
+   std::signal(SIGWINCH, SIG_DFL);
+   m_open = false;
+}
+
+void Cypher::AnsiTerminal::SetTitle(const wchar_t* title)
+{
+   m_output += "\x1b]0;";
+   for (; *title; ++title)
+      AppendGlyph(static_cast<uint32_t>(*title));
+   m_output += '\x07';
+}
+
+void Cypher::AnsiTerminal::Present(const CHAR_INFO* frame)
+{
+   if (!m_open)
+      return;
+
+   if (s_resized)
+   {
+      s_resized = 0;
+      m_fullRedraw = true;
+   }
+
+   m_runCount = 0;
+   m_stats.cellsWritten = 0;
+   if (m_fullRedraw)
+   {
+      // Make every cell differ from the last frame so each row is written in full
+      m_output += "\x1b[0m\x1b[2J";
+      m_attributes = -1;
+      m_cursorX = -1;
+      for (size_t i = 0; i < m_previous.size(); ++i)
+      {
+         m_previous[i] = frame[i];
+         m_previous[i].Attributes ^= 0xFFFF;
+      }
+      m_fullRedraw = false;
+   }
+
+   for (SHORT y = 0; y < m_height; ++y)
+   {
+      const CHAR_INFO* row = frame + static_cast<size_t>(y) * m_width;
+      if (std::memcmp(row, m_previous.data() + static_cast<size_t>(y) * m_width, m_width * sizeof(CHAR_INFO)) != 0)
+         PresentRow(row, y);
+   }
+
+   m_stats.regionCount = m_runCount;
+   m_stats.bytesWritten = static_cast<uint32_t>(m_output.size());
+   m_stats.totalBytesWritten += m_output.size();
+   ++m_stats.frameCount;
+
+   Flush();
+}
+
+void Cypher::AnsiTerminal::PresentRow(const CHAR_INFO* row, SHORT y)
+{
+   CHAR_INFO* previous = m_previous.data() + static_cast<size_t>(y) * m_width;
+   for (SHORT x = 0; x < m_width; ++x)
+   {
+      if (std::memcmp(&row[x], &previous[x], sizeof(CHAR_INFO)) == 0)
+         continue;
+
+      if (m_cursorY != y || m_cursorX != x)
+      {
+         // A few unchanged cells in the current colours are shorter to rewrite than a cursor move is to send
+         const SHORT gap = x - m_cursorX;
+         bool rewrite = m_cursorY == y && m_cursorX >= 0 && gap > 0 && gap <= MAX_SKIP_REWRITE;
+         for (SHORT i = m_cursorX; rewrite && i < x; ++i)
+            rewrite = row[i].Attributes == m_attributes;
+
+         if (rewrite)
+         {
+            for (SHORT i = m_cursorX; i < x; ++i)
+               AppendGlyph(row[i].Char.UnicodeChar);
+            m_stats.cellsWritten += gap;
+         }
+         else
+         {
+            MoveCursor(x, y);
+            ++m_runCount;
+         }
+      }
+
+      SetAttributes(row[x].Attributes);
+      AppendGlyph(row[x].Char.UnicodeChar);
+      ++m_stats.cellsWritten;
+      m_cursorX = x + 1;
+   }
+
+   std::memcpy(previous, row, m_width * sizeof(CHAR_INFO));
+}
+
+void Cypher::AnsiTerminal::MoveCursor(SHORT x, SHORT y)
+{
+   m_output += "\x1b[";
+   AppendNumber(static_cast<uint32_t>(y) + 1);
+   m_output += ';';
+   AppendNumber(static_cast<uint32_t>(x) + 1);
+   m_output += 'H';
+   m_cursorX = x;
+   m_cursorY = y;
+}
+
+void Cypher::AnsiTerminal::SetAttributes(WORD attributes)
+{
+   if (attributes == m_attributes)
+      return;
+
+   // Console colours are BGR bit sets with an intensity bit; ANSI numbers them RGB
+   static constexpr uint8_t ANSI_COLOR[8] = { 0, 4, 2, 6, 1, 5, 3, 7 };
+   const uint32_t foreground = attributes & 0xF;
+   const uint32_t background = (attributes >> 4) & 0xF;
+
+   m_output += "\x1b[0;";
+   AppendNumber((foreground & 0x8 ? 90 : 30) + ANSI_COLOR[foreground & 0x7]);
+   m_output += ';';
+   AppendNumber((background & 0x8 ? 100 : 40) + ANSI_COLOR[background & 0x7]);
+   if (attributes & COMMON_LVB_UNDERSCORE)
+      m_output += ";4";
+   if (attributes & COMMON_LVB_REVERSE_VIDEO)
+      m_output += ";7";
+   m_output += 'm';
+   m_attributes = attributes;
+}
+
+void Cypher::AnsiTerminal::AppendGlyph(uint32_t codePoint)
+{
+   // Control characters would be interpreted by the terminal, and lone surrogates have no encoding
+   if (codePoint == 0)
+      codePoint = ' ';
+   else if (codePoint < 0x20 || codePoint == 0x7F || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+      codePoint = '?';
+
+   StringUtil::AppendUTF8(m_output, codePoint);
+}
+
+void Cypher::AnsiTerminal::AppendNumber(uint32_t value)
+{
+   char digits[10];
+   std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+   m_output.append(digits, result.ptr);
+}
+
+void Cypher::AnsiTerminal::Flush()
+{
+   size_t written = 0;
+   while (written < m_output.size())
+   {
+      ssize_t count = write(STDOUT_FILENO, m_output.data() + written, m_output.size() - written);
+      if (count < 0)
+      {
+         if (errno == EINTR)
+            continue;
+         break;
+      }
+      written += static_cast<size_t>(count);
+   }
+   m_output.clear();
+}
+
+void Cypher::AnsiTerminal::PollInput()
+{
+   if (!m_open)
+      return;
+
+   m_pollTime = Clock::now();
+
+   char buffer[256];
+   for (;;)
+   {
+      ssize_t count = read(STDIN_FILENO, buffer, sizeof(buffer));
+      if (count <= 0)
+         break;
+      m_input.append(buffer, static_cast<size_t>(count));
+   }
+
+   size_t offset = 0;
+   while (offset < m_input.size())
+   {
+      size_t used = ParseSequence(m_input.data() + offset, m_input.size() - offset);
+      if (used == 0)
+      {
+         if (m_input.size() - offset > MAX_PENDING_INPUT)
+            offset = m_input.size();
+         break;
+      }
+      offset += used;
+   }
+   m_input.erase(0, offset);
+}
+
+bool Cypher::AnsiTerminal::IsKeyDown(size_t virtualKey) const
+{
+   if (virtualKey >= m_keys.size())
+      return false;
+
+   const KeyState& key = m_keys[virtualKey];
+   return m_pollTime - key.lastSeen < (key.repeating ? REPEAT_HOLD : INITIAL_HOLD);
+}
+
+size_t Cypher::AnsiTerminal::ParseSequence(const char* input, size_t length)
+{
+   const unsigned char c = static_cast<unsigned char>(input[0]);
+   if (c == 0x1B)
+   {
+      // An escape with nothing after it in the same read is the key itself
+      if (length == 1)
+      {
+         PressKey(Key(KeyCode::CY_ESCAPE));
+         return 1;
+      }
+
+      if (input[1] == '[')
+      {
+         if (length >= 3 && input[2] == '<')
+            return ParseMouse(input, length);
+
+         size_t i = 2;
+         uint32_t parameter = 0;
+         bool firstParameter = true;
+         for (; i < length && ((input[i] >= '0' && input[i] <= '9') || input[i] == ';'); ++i)
+         {
+            if (input[i] == ';')
+               firstParameter = false;
+            else if (firstParameter)
+               parameter = parameter * 10 + static_cast<uint32_t>(input[i] - '0');
+         }
+         if (i == length)
+            return 0;
+
+         switch (input[i])
+         {
+            case 'A': PressKey(Key(KeyCode::CY_UP)); break;
+            case 'B': PressKey(Key(KeyCode::CY_DOWN)); break;
+            case 'C': PressKey(Key(KeyCode::CY_RIGHT)); break;
+            case 'D': PressKey(Key(KeyCode::CY_LEFT)); break;
+            case 'H': PressKey(Key(KeyCode::CY_HOME)); break;
+            case 'F': PressKey(Key(KeyCode::CY_END)); break;
+            case '~':
+               switch (parameter)
+               {
+                  case 1: case 7: PressKey(Key(KeyCode::CY_HOME)); break;
+                  case 2: PressKey(Key(KeyCode::CY_INSERT)); break;
+                  case 3: PressKey(Key(KeyCode::CY_DELETE)); break;
+                  case 4: case 8: PressKey(Key(KeyCode::CY_END)); break;
+                  case 5: PressKey(Key(KeyCode::CY_PAGE_UP)); break;
+                  case 6: PressKey(Key(KeyCode::CY_PAGE_DOWN)); break;
+                  case 11: case 12: case 13: case 14: case 15:
+                     PressKey(static_cast<uint8_t>(Key(KeyCode::CY_F1) + parameter - 11));
+                     break;
+                  case 17: case 18: case 19: case 20: case 21:
+                     PressKey(static_cast<uint8_t>(Key(KeyCode::CY_F6) + parameter - 17));
+                     break;
+                  case 23: case 24:
+                     PressKey(static_cast<uint8_t>(Key(KeyCode::CY_F11) + parameter - 23));
+                     break;
+                  default:
+                     break;
+               }
+               break;
+            default:
+               break;
+         }
+         return i + 1;
+      }
+
+      if (input[1] == 'O')
+      {
+         if (length < 3)
+            return 0;
+
+         switch (input[2])
+         {
+            case 'P': case 'Q': case 'R': case 'S':
+               PressKey(static_cast<uint8_t>(Key(KeyCode::CY_F1) + (input[2] - 'P')));
+               break;
+            case 'A': PressKey(Key(KeyCode::CY_UP)); break;
+            case 'B': PressKey(Key(KeyCode::CY_DOWN)); break;
+            case 'C': PressKey(Key(KeyCode::CY_RIGHT)); break;
+            case 'D': PressKey(Key(KeyCode::CY_LEFT)); break;
+            case 'H': PressKey(Key(KeyCode::CY_HOME)); break;
+            case 'F': PressKey(Key(KeyCode::CY_END)); break;
+            default:
+               break;
+         }
+         return 3;
+      }
+
+      // Escape before an ordinary key is how terminals send Alt with it
+      PressKey(Key(KeyCode::CY_ALT));
+      return 1;
+   }
+
+   if (c == '\r' || c == '\n')
+   {
+      PressKey(Key(KeyCode::CY_ENTER));
+   }
+   else if (c == 0x7F || c == 0x08)
+   {
+      PressKey(Key(KeyCode::CY_BACKSPACE));
+   }
+   else if (c == '\t')
+   {
+      PressKey(Key(KeyCode::CY_TAB));
+   }
+   else if (c == ' ')
+   {
+      PressKey(Key(KeyCode::CY_SPACE));
+   }
+   else if (c >= 'a' && c <= 'z')
+   {
+      PressKey(static_cast<uint8_t>(c - 'a' + 'A'));
+   }
+   else if (c >= 'A' && c <= 'Z')
+   {
+      PressKey(Key(KeyCode::CY_SHIFT));
+      PressKey(c);
+   }
+   else if (c >= '0' && c <= '9')
+   {
+      PressKey(c);
+   }
+   else if (c >= 0x01 && c <= 0x1A)
+   {
+      PressKey(Key(KeyCode::CY_CONTROL));
+      PressKey(static_cast<uint8_t>(c - 0x01 + 'A'));
+   }
+   return 1;
+}
+
+size_t Cypher::AnsiTerminal::ParseMouse(const char* input, size_t length)
+{
+   // SGR report: ESC [ < button ; column ; row, then M for a press or motion and m for a release
+   uint32_t values[3] = {};
+   size_t field = 0;
+   size_t i = 3;
+   for (; i < length; ++i)
+   {
+      if (input[i] >= '0' && input[i] <= '9')
+         values[field] = values[field] * 10 + static_cast<uint32_t>(input[i] - '0');
+      else if (input[i] == ';' && field < 2)
+         ++field;
+      else
+         break;
+   }
+   if (i == length)
+      return 0;
+
+   const char final = input[i];
+   if (final != 'M' && final != 'm')
+      return i + 1;
+
+   m_mouse.x = static_cast<SHORT>(values[1] > 0 ? values[1] - 1 : 0);
+   m_mouse.y = static_cast<SHORT>(values[2] > 0 ? values[2] - 1 : 0);
+
+   // Wheel events carry no button state, and motion reports keep whatever is held
+   const uint32_t code = values[0];
+   if (!(code & 64) && !(code & 32))
+   {
+      static constexpr uint8_t BUTTON_BITS[4] = { 0x1, 0x4, 0x2, 0x0 };
+      const uint8_t bit = BUTTON_BITS[code & 3];
+      if (final == 'M')
+         m_mouse.buttons |= bit;
+      else
+         m_mouse.buttons &= ~bit;
+   }
+   return i + 1;
+}
+
+void Cypher::AnsiTerminal::PressKey(uint8_t virtualKey)
+{
+   KeyState& key = m_keys[virtualKey];
+   key.repeating = IsKeyDown(virtualKey);
+   key.lastSeen = m_pollTime;
+}
+
+#endif
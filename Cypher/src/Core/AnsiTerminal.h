@@ -0,0 +1,104 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <termios.h>
+
+#include "Common.h"
+#include "Core/Platform.h"
+#include "Rendering/FrameDiff.h"
+
+namespace Cypher
+{
+   // Console backend for POSIX terminals. Open switches the terminal to raw mode on the alternate screen with mouse
+   // reporting on; Present compares the cell buffer with the last frame it sent and emits only the cells that changed,
+   // moving the cursor only where a run breaks and changing colours only where they differ, and hands the whole frame
+   // to a single write(). Attributes use the Windows console layout so TextRenderer draws the same on both platforms.
+   //
+   // Terminals report key presses but not releases, so a key counts as held until it has gone quiet for longer than
+   // the keyboard's repeat delay (the first repeat) or repeat interval (after that).
+   class AnsiTerminal
+   {
+   public:
+      static constexpr std::chrono::milliseconds INITIAL_HOLD = std::chrono::milliseconds(500);
+      static constexpr std::chrono::milliseconds REPEAT_HOLD = std::chrono::milliseconds(100);
+      static constexpr SHORT MAX_SKIP_REWRITE = 4;   // Unchanged cells rewritten rather than jumped over with a cursor move
+
+      struct MouseState
+      {
+         SHORT x = 0;
+         SHORT y = 0;
+         uint8_t buttons = 0;   // Bit 0 left, bit 1 right, bit 2 middle, as in MOUSE_EVENT_RECORD::dwButtonState
+      };
+
+      AnsiTerminal();
+      ~AnsiTerminal();
+
+      AnsiTerminal(const AnsiTerminal&) = delete;
+      AnsiTerminal& operator=(const AnsiTerminal&) = delete;
+
+      // Fails if standard input or output is not a terminal, or the terminal is smaller than the requested size.
+      bool Open(SHORT width, SHORT height);
+      void Close();
+      inline bool IsOpen() const { return m_open; }
+
+      // Sent with the next Present.
+      void SetTitle(const wchar_t* title);
+
+      void Present(const CHAR_INFO* frame);
+      inline void Invalidate() { m_fullRedraw = true; }
+      inline const PresentStats& GetStats() const { return m_stats; }
+
+      // Reads and parses whatever input is pending without blocking.
+      void PollInput();
+      bool IsKeyDown(size_t virtualKey) const;
+      inline const MouseState& GetMouse() const { return m_mouse; }
+
+   private:
+      using Clock = std::chrono::steady_clock;
+
+      struct KeyState
+      {
+         Clock::time_point lastSeen;
+         bool repeating = false;
+      };
+
+      void PresentRow(const CHAR_INFO* row, SHORT y);
+      void MoveCursor(SHORT x, SHORT y);
+      void SetAttributes(WORD attributes);
+      void AppendGlyph(uint32_t codePoint);
+      void AppendNumber(uint32_t value);
+      void Flush();
+
+      size_t ParseSequence(const char* input, size_t length);
+      size_t ParseMouse(const char* input, size_t length);
+      void PressKey(uint8_t virtualKey);
+
+      bool m_open;
+      bool m_fullRedraw;
+      SHORT m_width;
+      SHORT m_height;
+      termios m_restoreMode;
+
+      std::vector<CHAR_INFO> m_previous;
+      std::string m_output;
+      SHORT m_cursorX;   // -1 when unknown
+      SHORT m_cursorY;
+      int32_t m_attributes;   // -1 when unknown
+      uint32_t m_runCount;
+      PresentStats m_stats;
+
+      std::string m_input;   // Bytes of an escape sequence split across reads
+      std::array<KeyState, 256> m_keys;
+      Clock::time_point m_pollTime;
+      MouseState m_mouse;
+   };
+}
+
+#endif
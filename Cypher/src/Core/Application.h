@@ -1,9 +1,9 @@
 #pragma once
 
 #include <string>
-#include <Windows.h>
 
 #include "Common.h"
+#include "Core/Platform.h"
 
 namespace Cypher
 {
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "Common.h"
+
+namespace Cypher
+{
+   // Fixed-step accumulator on integer time. Elapsed nanoseconds are accumulated scaled by the step rate, so one step is
+   // exactly NANOSECONDS_PER_SECOND units whatever the rate and no rounding error builds up between steps. Every step
+   // hands the simulation the same step length, which together with the step count is all a lockstep replay needs.
+   class FixedTimestep
+   {
+   public:
+      static constexpr uint64_t NANOSECONDS_PER_SECOND = 1'000'000'000;
+      static constexpr uint32_t DEFAULT_MAX_STEPS = 5;
+
+      explicit FixedTimestep(uint32_t stepsPerSecond, uint32_t maxStepsPerAdvance = DEFAULT_MAX_STEPS) :
+         m_stepsPerSecond(stepsPerSecond),
+         m_maxSteps(maxStepsPerAdvance),
+         m_accumulator(0),
+         m_stepCount(0),
+         m_droppedSteps(0)
+      {
+         Assert(stepsPerSecond > 0 && maxStepsPerAdvance > 0);
+      }
+
+      // Changing the rate keeps the fraction of a step already accumulated.
+      void SetStepRate(uint32_t stepsPerSecond)
+      {
+         Assert(stepsPerSecond > 0);
+         m_accumulator = m_accumulator * stepsPerSecond / m_stepsPerSecond;
+         m_stepsPerSecond = stepsPerSecond;
+      }
+
+      inline uint32_t GetStepRate() const { return m_stepsPerSecond; }
+      inline float GetStepSeconds() const { return 1.0f / static_cast<float>(m_stepsPerSecond); }
+      inline std::chrono::nanoseconds GetStepDuration() const { return std::chrono::nanoseconds(NANOSECONDS_PER_SECOND / m_stepsPerSecond); }
+
+      // Adds elapsed time and returns how many steps are due. Beyond the per-advance limit whole steps are dropped
+      // rather than run late, so a long stall cannot send the simulation into a spiral of catching up.
+      uint32_t Advance(std::chrono::nanoseconds elapsed)
+      {
+         if (elapsed.count() <= 0)
+            return 0;
+
+         // The accumulator stays below one step between calls, so this only overflows after a stall of months
+         m_accumulator += static_cast<uint64_t>(elapsed.count()) * m_stepsPerSecond;
+
+         uint64_t due = m_accumulator / NANOSECONDS_PER_SECOND;
+         m_accumulator %= NANOSECONDS_PER_SECOND;
+
+         uint32_t steps = due > m_maxSteps ? m_maxSteps : static_cast<uint32_t>(due);
+         m_droppedSteps += due - steps;
+         m_stepCount += steps;
+         return steps;
+      }
+
+      // Fraction of the next step already elapsed, for blending the previous step into the latest one.
+      inline float GetAlpha() const { return static_cast<float>(static_cast<double>(m_accumulator) / NANOSECONDS_PER_SECOND); }
+      inline std::chrono::nanoseconds GetAccumulated() const { return std::chrono::nanoseconds(m_accumulator / m_stepsPerSecond); }
+
+      inline uint64_t GetStepCount() const { return m_stepCount; }
+      inline uint64_t GetDroppedSteps() const { return m_droppedSteps; }
+
+      void Reset()
+      {
+         m_accumulator = 0;
+         m_stepCount = 0;
+         m_droppedSteps = 0;
+      }
+
+   private:
+      uint32_t m_stepsPerSecond;
+      uint32_t m_maxSteps;
+      uint64_t m_accumulator;   // Nanoseconds times steps per second
+      uint64_t m_stepCount;
+      uint64_t m_droppedSteps;
+   };
+}
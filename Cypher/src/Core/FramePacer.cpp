@@ -0,0 +1,105 @@
+#include "FramePacer.h"
+
+#include <thread>
+
+#ifdef _WIN32
+   #include <Windows.h>
+   #pragma comment(lib, "winmm.lib")
+#endif
+
+Cypher::FramePacer::FramePacer(uint32_t targetRate) :
+   m_targetRate(UNCAPPED),
+   m_period(Clock::duration::zero()),
+   m_deadline(Clock::now()),
+   m_spinThreshold(DEFAULT_SPIN_THRESHOLD),
+   m_sleepOvershoot(Clock::duration::zero()),
+   m_frameCount(0),
+   m_missedDeadlines(0),
+   m_lastLateness(Clock::duration::zero()),
+   m_worstLateness(Clock::duration::zero()),
+   m_timerPeriodRaised(false)
+{
+   SetTargetRate(targetRate);
+}
+
+Cypher::FramePacer::~FramePacer()
+{
+   SetTargetRate(UNCAPPED);
+}
+
+void Cypher::FramePacer::SetTargetRate(uint32_t framesPerSecond)
+{
+   m_targetRate = framesPerSecond;
+   m_period = IsUncapped() ? Clock::duration::zero() : std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(1'000'000'000 / framesPerSecond));
+
+#ifdef _WIN32
+   // The default Windows timer tick is 15.6 ms, far coarser than a frame; raise it to 1 ms only while pacing
+   if (!IsUncapped() && !m_timerPeriodRaised)
+      m_timerPeriodRaised = timeBeginPeriod(1) == TIMERR_NOERROR;
+   else if (IsUncapped() && m_timerPeriodRaised)
+   {
+      timeEndPeriod(1);
+      m_timerPeriodRaised = false;
+   }
+#endif
+
+   Reset();
+}
+
+void Cypher::FramePacer::SetSpinThreshold(Clock::duration threshold)
+{
+   m_spinThreshold = threshold;
+}
+
+bool Cypher::FramePacer::Wait()
+{
+   ++m_frameCount;
+   if (IsUncapped())
+      return true;
+
+   Clock::time_point now = Clock::now();
+   if (now > m_deadline)
+   {
+      ++m_missedDeadlines;
+      m_lastLateness = now - m_deadline;
+      if (m_lastLateness > m_worstLateness)
+         m_worstLateness = m_lastLateness;
+
+      m_deadline = (m_lastLateness > m_period ? now : m_deadline) + m_period;
+      return false;
+   }
+
+   SleepUntil(m_deadline);
+   m_lastLateness = Clock::duration::zero();
+   m_deadline += m_period;
+   return true;
+}
+
+void Cypher::FramePacer::Reset()
+{
+   m_deadline = Clock::now() + m_period;
+}
+
+void Cypher::FramePacer::SleepUntil(Clock::time_point deadline)
+{
+   // Coarse phase: sleep in steps while the deadline is further away than the scheduler can be trusted to wake us
+   for (;;)
+   {
+      Clock::duration margin = m_spinThreshold > m_sleepOvershoot * 2 ? m_spinThreshold : m_sleepOvershoot * 2;
+      Clock::time_point now = Clock::now();
+      if (deadline - now <= margin)
+         break;
+
+      Clock::duration requested = deadline - now - margin;
+      std::this_thread::sleep_for(requested);
+
+      Clock::duration overshoot = Clock::now() - now - requested;
+      if (overshoot < Clock::duration::zero())
+         overshoot = Clock::duration::zero();
+      m_sleepOvershoot = (m_sleepOvershoot * 7 + overshoot) / 8;
+   }
+
+   // Fine phase: give the core away between checks so a shared machine still gets it
+   while (Clock::now() < deadline)
+      std::this_thread::yield();
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "Common.h"
+
+namespace Cypher
+{
+   // Holds a loop to a fixed rate against absolute steady_clock deadlines, so lateness in one frame does not push every
+   // later frame back. Waiting sleeps coarsely until the deadline is within the spin threshold and then spins with
+   // yields for the remainder, which keeps CPU use low without inheriting the scheduler's sleep granularity. The
+   // threshold widens on its own when sleeps are seen to overshoot by more than it allows for.
+   class FramePacer
+   {
+   public:
+      using Clock = std::chrono::steady_clock;
+
+      static constexpr uint32_t UNCAPPED = 0;
+      static constexpr std::chrono::microseconds DEFAULT_SPIN_THRESHOLD = std::chrono::microseconds(1000);
+
+      explicit FramePacer(uint32_t targetRate = UNCAPPED);
+      ~FramePacer();
+
+      FramePacer(const FramePacer&) = delete;
+      FramePacer& operator=(const FramePacer&) = delete;
+
+      // Frames per second to hold to, or UNCAPPED to return from Wait immediately, e.g. for benchmarking.
+      void SetTargetRate(uint32_t framesPerSecond);
+      inline uint32_t GetTargetRate() const { return m_targetRate; }
+      inline bool IsUncapped() const { return m_targetRate == UNCAPPED; }
+      inline Clock::duration GetFramePeriod() const { return m_period; }
+
+      void SetSpinThreshold(Clock::duration threshold);
+      inline Clock::duration GetSpinThreshold() const { return m_spinThreshold; }
+
+      // Blocks until the current frame's deadline and schedules the next one. Returns false if the deadline had already
+      // passed; a frame more than a whole period late restarts the schedule from now instead of running catch-up frames.
+      bool Wait();
+
+      // Restarts the schedule from now, e.g. after a deliberate pause that should not count as missed deadlines.
+      void Reset();
+
+      inline uint64_t GetFrameCount() const { return m_frameCount; }
+      inline uint64_t GetMissedDeadlines() const { return m_missedDeadlines; }
+      inline Clock::duration GetLastLateness() const { return m_lastLateness; }
+      inline Clock::duration GetWorstLateness() const { return m_worstLateness; }
+
+   private:
+      void SleepUntil(Clock::time_point deadline);
+
+      uint32_t m_targetRate;
+      Clock::duration m_period;
+      Clock::time_point m_deadline;
+
+      Clock::duration m_spinThreshold;
+      Clock::duration m_sleepOvershoot;   // Smoothed amount coarse sleeps wake up later than asked
+
+      uint64_t m_frameCount;
+      uint64_t m_missedDeadlines;
+      Clock::duration m_lastLateness;
+      Clock::duration m_worstLateness;
+      bool m_timerPeriodRaised;
+   };
+}
@@ -0,0 +1,203 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Core/Logger.h"
+
+Cypher::FrameStats::FrameStats(std::chrono::nanoseconds spikeBudget) :
+   m_window(),
+   m_frameCount(0),
+   m_scratch(),
+   m_spikes(),
+   m_spikeCount(0),
+   m_pendingSpikes(),
+   m_pendingCount(0),
+   m_spikeBudget(static_cast<uint64_t>(spikeBudget.count())),
+   m_current(),
+   m_frameStart(Clock::now())
+{
+}
+
+void Cypher::FrameStats::BeginFrame()
+{
+   m_frameStart = Clock::now();
+}
+
+void Cypher::FrameStats::EndFrame()
+{
+   AddPhaseTime(FramePhase::Frame, Clock::now() - m_frameStart);
+
+   std::lock_guard<std::mutex> lock(m_lock);
+   m_current.frame = m_frameCount;
+   m_window[m_frameCount % WINDOW_SIZE] = m_current;
+
+   // A spike is captured once the frames after it are in the window too; spikes arriving while MAX_SPIKES are already
+   // waiting are dropped, since they fall inside the context of the ones waiting anyway
+   if (m_spikeBudget && m_current.Get(FramePhase::Frame) > m_spikeBudget && m_pendingCount < MAX_SPIKES)
+      m_pendingSpikes[m_pendingCount++] = m_frameCount;
+
+   size_t remaining = 0;
+   for (size_t i = 0; i < m_pendingCount; ++i)
+   {
+      if (m_pendingSpikes[i] + FrameSpike::CONTEXT <= m_frameCount)
+         CaptureSpike(m_pendingSpikes[i]);
+      else
+         m_pendingSpikes[remaining++] = m_pendingSpikes[i];
+   }
+   m_pendingCount = remaining;
+
+   ++m_frameCount;
+   m_current = FrameTiming();
+}
+
+void Cypher::FrameStats::SetSpikeBudget(std::chrono::nanoseconds budget)
+{
+   std::lock_guard<std::mutex> lock(m_lock);
+   m_spikeBudget = static_cast<uint64_t>(budget.count());
+}
+
+std::chrono::nanoseconds Cypher::FrameStats::GetSpikeBudget() const
+{
+   std::lock_guard<std::mutex> lock(m_lock);
+   return std::chrono::nanoseconds(m_spikeBudget);
+}
+
+Cypher::FramePercentiles Cypher::FrameStats::GetPercentiles(FramePhase phase) const
+{
+   std::lock_guard<std::mutex> lock(m_lock);
+
+   FramePercentiles percentiles;
+   percentiles.samples = static_cast<size_t>(std::min<uint64_t>(m_frameCount, WINDOW_SIZE));
+   if (percentiles.samples == 0)
+      return percentiles;
+
+   for (size_t i = 0; i < percentiles.samples; ++i)
+      m_scratch[i] = m_window[i].Get(phase);
+
+   // Nearest-rank percentiles; each selection only reorders the part of the range the next one still has to look at
+   const auto first = m_scratch.begin();
+   const auto end = first + percentiles.samples;
+   auto begin = first;
+   auto select = [&](double fraction)
+   {
+      size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(percentiles.samples)));
+      auto nth = first + (std::max<size_t>(rank, 1) - 1);
+      std::nth_element(begin, nth, end);
+      begin = nth;
+      return *nth;
+   };
+
+   percentiles.p50 = select(0.50);
+   percentiles.p95 = select(0.95);
+   percentiles.p99 = select(0.99);
+   percentiles.max = *std::max_element(begin, end);
+   return percentiles;
+}
+
+Cypher::FrameHistogram Cypher::FrameStats::GetHistogram(FramePhase phase, std::chrono::nanoseconds bucketWidth) const
+{
+   Assert(bucketWidth.count() > 0);
+   std::lock_guard<std::mutex> lock(m_lock);
+
+   FrameHistogram histogram;
+   histogram.bucketWidth = static_cast<uint64_t>(bucketWidth.count());
+
+   size_t samples = static_cast<size_t>(std::min<uint64_t>(m_frameCount, WINDOW_SIZE));
+   for (size_t i = 0; i < samples; ++i)
+   {
+      uint64_t bucket = std::min<uint64_t>(m_window[i].Get(phase) / histogram.bucketWidth, FrameHistogram::BUCKET_COUNT - 1);
+      ++histogram.counts[bucket];
+   }
+   return histogram;
+}
+
+std::vector<Cypher::FrameSpike> Cypher::FrameStats::GetSpikes() const
+{
+   std::lock_guard<std::mutex> lock(m_lock);
+
+   size_t count = static_cast<size_t>(std::min<uint64_t>(m_spikeCount, MAX_SPIKES));
+   std::vector<FrameSpike> spikes;
+   spikes.reserve(count);
+   for (uint64_t i = m_spikeCount - count; i < m_spikeCount; ++i)
+      spikes.push_back(m_spikes[i % MAX_SPIKES]);
+   return spikes;
+}
+
+uint64_t Cypher::FrameStats::GetSpikeCount() const
+{
+   std::lock_guard<std::mutex> lock(m_lock);
+   return m_spikeCount;
+}
+
+size_t Cypher::FrameStats::GetHistory(std::span<FrameTiming> out) const
+{
+   std::lock_guard<std::mutex> lock(m_lock);
+
+   size_t count = static_cast<size_t>(std::min<uint64_t>({ m_frameCount, WINDOW_SIZE, out.size() }));
+   uint64_t first = m_frameCount - count;
+   for (size_t i = 0; i < count; ++i)
+      out[i] = m_window[(first + i) % WINDOW_SIZE];
+   return count;
+}
+
+uint64_t Cypher::FrameStats::GetFrameCount() const
+{
+   std::lock_guard<std::mutex> lock(m_lock);
+   return m_frameCount;
+}
+
+void Cypher::FrameStats::LogSummary() const
+{
+   constexpr double toMilliseconds = 1.0 / 1'000'000.0;
+
+   for (size_t i = 0; i < static_cast<size_t>(FramePhase::Count); ++i)
+   {
+      FramePhase phase = static_cast<FramePhase>(i);
+      FramePercentiles percentiles = GetPercentiles(phase);
+      const char* name = GetPhaseName(phase);
+      double p50 = percentiles.p50 * toMilliseconds;
+      double p95 = percentiles.p95 * toMilliseconds;
+      double p99 = percentiles.p99 * toMilliseconds;
+      double max = percentiles.max * toMilliseconds;
+      LOG_INFO("Frame [{}] p50: {:.3f} ms, p95: {:.3f} ms, p99: {:.3f} ms, max: {:.3f} ms over {} frames",
+         name, p50, p95, p99, max, percentiles.samples);
+   }
+
+   uint64_t spikes = GetSpikeCount();
+   LOG_INFO("Frame spikes over budget: {}", spikes);
+}
+
+void Cypher::FrameStats::Reset()
+{
+   std::lock_guard<std::mutex> lock(m_lock);
+   m_frameCount = 0;
+   m_spikeCount = 0;
+   m_pendingCount = 0;
+}
+
+const char* Cypher::FrameStats::GetPhaseName(FramePhase phase)
+{
+   switch (phase)
+   {
+      case FramePhase::Input:       return "Input";
+      case FramePhase::Update:      return "Update";
+      case FramePhase::FixedUpdate: return "FixedUpdate";
+      case FramePhase::Render:      return "Render";
+      case FramePhase::Present:     return "Present";
+      case FramePhase::Frame:       return "Frame";
+      default:                      return "Unknown";
+   }
+}
+
+void Cypher::FrameStats::CaptureSpike(uint64_t frame)
+{
+   FrameSpike& spike = m_spikes[m_spikeCount++ % MAX_SPIKES];
+   spike.frame = frame;
+
+   uint64_t first = frame >= FrameSpike::CONTEXT ? frame - FrameSpike::CONTEXT : 0;
+   uint64_t last = std::min(frame + FrameSpike::CONTEXT, m_frameCount);
+   spike.count = static_cast<size_t>(last - first + 1);
+   for (size_t i = 0; i < spike.count; ++i)
+      spike.timings[i] = m_window[(first + i) % WINDOW_SIZE];
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "Common.h"
+
+namespace Cypher
+{
+   // Timed sections of a console frame. Frame is the whole frame including any wait for the next one.
+   enum class FramePhase : uint8_t
+   {
+      Input,
+      Update,
+      FixedUpdate,
+      Render,
+      Present,
+      Frame,
+      Count
+   };
+
+   struct FrameTiming
+   {
+      uint64_t frame = 0;
+      std::array<uint64_t, static_cast<size_t>(FramePhase::Count)> nanoseconds = {};
+
+      inline uint64_t Get(FramePhase phase) const { return nanoseconds[static_cast<size_t>(phase)]; }
+   };
+
+   struct FramePercentiles
+   {
+      uint64_t p50 = 0;   // Nanoseconds
+      uint64_t p95 = 0;
+      uint64_t p99 = 0;
+      uint64_t max = 0;
+      size_t samples = 0;
+   };
+
+   struct FrameHistogram
+   {
+      static constexpr size_t BUCKET_COUNT = 32;
+
+      uint64_t bucketWidth = 0;                       // Nanoseconds per bucket; the last bucket also holds everything beyond
+      std::array<uint32_t, BUCKET_COUNT> counts = {};
+   };
+
+   // Timings of the frames around one that went over budget, oldest first.
+   struct FrameSpike
+   {
+      static constexpr size_t CONTEXT = 8;   // Frames kept on each side of the spike
+
+      uint64_t frame = 0;
+      std::array<FrameTiming, CONTEXT * 2 + 1> timings = {};
+      size_t count = 0;
+   };
+
+   // Rolling per-phase frame timings. The frame thread calls BeginFrame, AddPhaseTime (usually via PhaseTimer) and
+   // EndFrame, none of which allocate; the queries may be called from any thread and work on the last WINDOW_SIZE frames.
+   // A frame whose total exceeds the spike budget is captured together with its neighbours once they have completed.
+   class FrameStats
+   {
+   public:
+      using Clock = std::chrono::steady_clock;
+
+      static constexpr size_t WINDOW_SIZE = 1024;
+      static constexpr size_t MAX_SPIKES = 16;
+
+      explicit FrameStats(std::chrono::nanoseconds spikeBudget = std::chrono::nanoseconds::zero());
+
+      void BeginFrame();
+      void EndFrame();
+      inline void AddPhaseTime(FramePhase phase, Clock::duration elapsed)
+      {
+         m_current.nanoseconds[static_cast<size_t>(phase)] += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+      }
+
+      // Frames over this total are captured as spikes; zero disables capture.
+      void SetSpikeBudget(std::chrono::nanoseconds budget);
+      std::chrono::nanoseconds GetSpikeBudget() const;
+
+      FramePercentiles GetPercentiles(FramePhase phase) const;
+      FrameHistogram GetHistogram(FramePhase phase, std::chrono::nanoseconds bucketWidth = std::chrono::milliseconds(1)) const;
+
+      // The most recent spikes, oldest first, and how many have been captured in total.
+      std::vector<FrameSpike> GetSpikes() const;
+      uint64_t GetSpikeCount() const;
+
+      // Copies up to out.size() of the most recent frames, oldest first, and returns how many were written.
+      size_t GetHistory(std::span<FrameTiming> out) const;
+      uint64_t GetFrameCount() const;
+
+      void LogSummary() const;
+      void Reset();
+
+      class PhaseTimer
+      {
+      public:
+         PhaseTimer(FrameStats& stats, FramePhase phase) :
+            m_stats(stats),
+            m_phase(phase),
+            m_start(Clock::now())
+         {}
+
+         ~PhaseTimer() { m_stats.AddPhaseTime(m_phase, Clock::now() - m_start); }
+
+         PhaseTimer(const PhaseTimer&) = delete;
+         PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+      private:
+         FrameStats& m_stats;
+         FramePhase m_phase;
+         Clock::time_point m_start;
+      };
+
+      static const char* GetPhaseName(FramePhase phase);
+
+   private:
+      void CaptureSpike(uint64_t frame);
+
+      mutable std::mutex m_lock;
+      std::array<FrameTiming, WINDOW_SIZE> m_window;
+      uint64_t m_frameCount;
+      mutable std::array<uint64_t, WINDOW_SIZE> m_scratch;
+
+      std::array<FrameSpike, MAX_SPIKES> m_spikes;
+      uint64_t m_spikeCount;
+      std::array<uint64_t, MAX_SPIKES> m_pendingSpikes;
+      size_t m_pendingCount;
+      uint64_t m_spikeBudget;
+
+      // Owned by the frame thread
+      FrameTiming m_current;
+      Clock::time_point m_frameStart;
+   };
+}
@@ -0,0 +1,187 @@
+#include "Memory.h"
+
+#include <array>
+#include <atomic>
+#include <string>
+
+#include "Core/Logger.h"
+#include "Core/MemoryProfiler.h"
+
+#ifdef CYPHER_USE_JEMALLOC
+   #include <jemalloc/jemalloc.h>
+#endif
+
+namespace
+{
+   constexpr size_t ARENA_COUNT = static_cast<size_t>(Cypher::MemoryArena::Count);
+
+#ifdef CYPHER_USE_JEMALLOC
+   // One explicit jemalloc arena per MemoryArena, created on first use.
+   struct JemallocArenas
+   {
+      std::array<unsigned, ARENA_COUNT> indices = {};
+
+      JemallocArenas()
+      {
+         for (unsigned& index : indices)
+         {
+            size_t size = sizeof(index);
+            if (mallctl("arenas.create", &index, &size, nullptr, 0) != 0)
+               index = 0;
+         }
+      }
+   };
+
+   JemallocArenas& GetArenas()
+   {
+      static JemallocArenas arenas;
+      return arenas;
+   }
+
+   // Explicit thread caches, one per arena per thread, so the fast path stays lock-free without mixing arenas.
+   struct ThreadCaches
+   {
+      std::array<unsigned, ARENA_COUNT> ids = {};
+      std::array<bool, ARENA_COUNT> created = {};
+
+      ~ThreadCaches()
+      {
+         for (size_t i = 0; i < ARENA_COUNT; ++i)
+         {
+            if (created[i])
+               mallctl("tcache.destroy", nullptr, nullptr, &ids[i], sizeof(ids[i]));
+         }
+      }
+
+      int Get(size_t arena)
+      {
+         if (!created[arena])
+         {
+            size_t size = sizeof(ids[arena]);
+            if (mallctl("tcache.create", &ids[arena], &size, nullptr, 0) != 0)
+               return MALLOCX_TCACHE_NONE;
+            created[arena] = true;
+         }
+         return MALLOCX_TCACHE(ids[arena]);
+      }
+   };
+
+   thread_local ThreadCaches t_caches;
+
+   // Frees only need the thread cache and alignment; the owning arena is found from the pointer.
+   int GetFreeFlags(Cypher::MemoryArena arena, size_t alignment)
+   {
+      int flags = t_caches.Get(static_cast<size_t>(arena));
+      if (alignment > Cypher::Memory::DEFAULT_ALIGNMENT)
+         flags |= MALLOCX_ALIGN(alignment);
+      return flags;
+   }
+
+   int GetFlags(Cypher::MemoryArena arena, size_t alignment)
+   {
+      return MALLOCX_ARENA(GetArenas().indices[static_cast<size_t>(arena)]) | GetFreeFlags(arena, alignment);
+   }
+
+   template<typename T>
+   T ReadStat(const std::string& name)
+   {
+      T value = 0;
+      size_t size = sizeof(value);
+      mallctl(name.c_str(), &value, &size, nullptr, 0);
+      return value;
+   }
+#else
+   std::array<std::atomic<size_t>, ARENA_COUNT> g_allocated = {};
+#endif
+}
+
+void* Cypher::Memory::Allocate(size_t size, size_t alignment, MemoryArena arena)
+{
+   Assert(arena < MemoryArena::Count);
+
+#ifdef CYPHER_USE_JEMALLOC
+   void* pointer = mallocx(size ? size : 1, GetFlags(arena, alignment));
+   if (!pointer)
+      throw std::bad_alloc();
+   #ifdef CYPHER_TRACK_ALLOCATIONS
+      MemoryProfiler::RecordAllocation(size);
+   #endif
+   return pointer;
+#else
+   g_allocated[static_cast<size_t>(arena)].fetch_add(size, std::memory_order_relaxed);
+   return ::operator new(size, std::align_val_t(alignment));
+#endif
+}
+
+void Cypher::Memory::Deallocate(void* pointer, size_t size, size_t alignment, MemoryArena arena)
+{
+   if (!pointer)
+      return;
+
+#ifdef CYPHER_USE_JEMALLOC
+   sdallocx(pointer, size ? size : 1, GetFreeFlags(arena, alignment));
+   #ifdef CYPHER_TRACK_ALLOCATIONS
+      MemoryProfiler::RecordFree(size);
+   #endif
+#else
+   g_allocated[static_cast<size_t>(arena)].fetch_sub(size, std::memory_order_relaxed);
+   ::operator delete(pointer, std::align_val_t(alignment));
+#endif
+}
+
+Cypher::MemoryArenaStats Cypher::Memory::GetStats(MemoryArena arena)
+{
+   Assert(arena < MemoryArena::Count);
+
+   MemoryArenaStats stats;
+#ifdef CYPHER_USE_JEMALLOC
+   // Statistics are cached by jemalloc until the epoch is advanced
+   uint64_t epoch = 1;
+   size_t epochSize = sizeof(epoch);
+   mallctl("epoch", &epoch, &epochSize, &epoch, epochSize);
+
+   const std::string prefix = "stats.arenas." + std::to_string(GetArenas().indices[static_cast<size_t>(arena)]) + ".";
+   stats.allocated = ReadStat<size_t>(prefix + "small.allocated") + ReadStat<size_t>(prefix + "large.allocated");
+   stats.active = ReadStat<size_t>(prefix + "pactive") * ReadStat<size_t>("arenas.page");
+   stats.resident = ReadStat<size_t>(prefix + "resident");
+#else
+   stats.allocated = g_allocated[static_cast<size_t>(arena)].load(std::memory_order_relaxed);
+   stats.active = stats.allocated;
+   stats.resident = stats.allocated;
+#endif
+   return stats;
+}
+
+void Cypher::Memory::LogStats()
+{
+   for (size_t i = 0; i < ARENA_COUNT; ++i)
+   {
+      MemoryArena arena = static_cast<MemoryArena>(i);
+      MemoryArenaStats stats = GetStats(arena);
+      const char* name = GetArenaName(arena);
+      double fragmentation = stats.Fragmentation() * 100.0;
+      LOG_INFO("Memory [{}] allocated: {} B, active: {} B, resident: {} B, fragmentation: {:.1f}%",
+         name, stats.allocated, stats.active, stats.resident, fragmentation);
+   }
+}
+
+const char* Cypher::Memory::GetArenaName(MemoryArena arena)
+{
+   switch (arena)
+   {
+      case MemoryArena::General:   return "General";
+      case MemoryArena::Rendering: return "Rendering";
+      case MemoryArena::ECS:       return "ECS";
+      case MemoryArena::Loading:   return "Loading";
+      default:                     return "Unknown";
+   }
+}
+
+bool Cypher::Memory::IsUsingJemalloc()
+{
+#ifdef CYPHER_USE_JEMALLOC
+   return true;
+#else
+   return false;
+#endif
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "Common.h"
+
+namespace Cypher
+{
+   // Allocation domains with separate heaps when jemalloc is enabled, so long-lived and churning memory do not fragment
+   // each other and each domain's footprint can be read on its own.
+   enum class MemoryArena : uint8_t
+   {
+      General,
+      Rendering,
+      ECS,
+      Loading,
+      Count
+   };
+
+   struct MemoryArenaStats
+   {
+      size_t allocated = 0;   // Bytes handed out and not yet freed
+      size_t active = 0;      // Bytes in pages that hold at least one live allocation
+      size_t resident = 0;    // Bytes physically backed by the allocator for this arena
+
+      // Share of active pages not covered by live allocations.
+      inline double Fragmentation() const { return active ? 1.0 - static_cast<double>(allocated) / static_cast<double>(active) : 0.0; }
+   };
+
+   // Engine allocation facade. With CYPHER_USE_JEMALLOC defined (premake --with-jemalloc) every arena is a jemalloc arena
+   // with its own per-thread cache; otherwise allocations go to the global heap and the stats only count live bytes.
+   class Memory
+   {
+   public:
+      static constexpr size_t DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+
+      [[nodiscard]] static void* Allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT, MemoryArena arena = MemoryArena::General);
+      static void Deallocate(void* pointer, size_t size, size_t alignment = DEFAULT_ALIGNMENT, MemoryArena arena = MemoryArena::General);
+
+      static MemoryArenaStats GetStats(MemoryArena arena);
+      static void LogStats();
+
+      static const char* GetArenaName(MemoryArena arena);
+      static bool IsUsingJemalloc();
+
+   private:
+      Memory() = delete;
+   };
+
+   // Standard allocator over one memory arena, usable with std containers and Symphony's Allocator concept.
+   template<typename T, MemoryArena Arena = MemoryArena::General>
+   class ArenaAllocator
+   {
+   public:
+      using value_type = T;
+
+      template<typename U>
+      struct rebind
+      {
+         using other = ArenaAllocator<U, Arena>;
+      };
+
+      ArenaAllocator() noexcept = default;
+
+      template<typename U>
+      ArenaAllocator(const ArenaAllocator<U, Arena>&) noexcept {}
+
+      [[nodiscard]] T* allocate(size_t n) { return static_cast<T*>(Memory::Allocate(n * sizeof(T), alignof(T), Arena)); }
+      void deallocate(T* pointer, size_t n) { Memory::Deallocate(pointer, n * sizeof(T), alignof(T), Arena); }
+
+      template<typename U>
+      bool operator==(const ArenaAllocator<U, Arena>&) const noexcept { return true; }
+   };
+}
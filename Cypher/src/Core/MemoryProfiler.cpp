@@ -0,0 +1,371 @@
+#include "MemoryProfiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "Core/Logger.h"
+
+namespace
+{
+   using Cypher::AllocationCounters;
+   using Cypher::MemoryFrameStats;
+   using Cypher::MemoryProfiler;
+
+   // All state is constant-initialized so allocations made during static initialization can already be recorded.
+   struct ScopeSlot
+   {
+      std::atomic<const char*> name;
+      std::atomic<uint64_t> frameAllocations;
+      std::atomic<uint64_t> frameBytes;
+
+      // Only touched by EndFrame, Reset and readers, under g_frameLock
+      uint64_t allocations = 0;
+      uint64_t bytesAllocated = 0;
+      uint64_t lastFrameAllocations = 0;
+      uint64_t lastFrameBytes = 0;
+      uint64_t peakFrameAllocations = 0;
+      uint64_t peakFrameBytes = 0;
+   };
+
+   std::array<ScopeSlot, MemoryProfiler::MAX_SCOPES> g_scopes;
+   std::atomic<uint32_t> g_scopeCount(1);
+   std::mutex g_registerLock;
+
+   std::atomic<uint64_t> g_frameAllocations;
+   std::atomic<uint64_t> g_frameFrees;
+   std::atomic<uint64_t> g_frameBytesAllocated;
+   std::atomic<uint64_t> g_frameBytesFreed;
+   std::atomic<size_t> g_liveBytes;
+   std::atomic<size_t> g_framePeakLiveBytes;
+
+   std::mutex g_frameLock;
+   std::array<MemoryFrameStats, MemoryProfiler::HISTORY_SIZE> g_history;
+   uint64_t g_frameCount = 0;
+   MemoryFrameStats g_peakFrame;
+   size_t g_peakLiveBytes = 0;
+
+   thread_local uint32_t t_scope = MemoryProfiler::UNTAGGED;
+   thread_local AllocationCounters t_counters;
+
+   const char* GetScopeName(uint32_t tag)
+   {
+      const char* name = g_scopes[tag].name.load(std::memory_order_acquire);
+      return name ? name : "Untagged";
+   }
+
+   Cypher::MemoryScopeStats GetScopeStatsLocked(uint32_t tag)
+   {
+      const ScopeSlot& slot = g_scopes[tag];
+
+      Cypher::MemoryScopeStats stats;
+      stats.name = GetScopeName(tag);
+      stats.allocations = slot.allocations;
+      stats.bytesAllocated = slot.bytesAllocated;
+      stats.frameAllocations = slot.lastFrameAllocations;
+      stats.frameBytes = slot.lastFrameBytes;
+      stats.peakFrameAllocations = slot.peakFrameAllocations;
+      stats.peakFrameBytes = slot.peakFrameBytes;
+      return stats;
+   }
+}
+
+void Cypher::MemoryProfiler::RecordAllocation(size_t size)
+{
+   ++t_counters.allocations;
+   t_counters.bytesAllocated += size;
+
+   g_frameAllocations.fetch_add(1, std::memory_order_relaxed);
+   g_frameBytesAllocated.fetch_add(size, std::memory_order_relaxed);
+
+   size_t live = g_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+   size_t peak = g_framePeakLiveBytes.load(std::memory_order_relaxed);
+   while (live > peak && !g_framePeakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+   {
+   }
+
+   ScopeSlot& slot = g_scopes[t_scope];
+   slot.frameAllocations.fetch_add(1, std::memory_order_relaxed);
+   slot.frameBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void Cypher::MemoryProfiler::RecordFree(size_t size)
+{
+   ++t_counters.frees;
+   t_counters.bytesFreed += size;
+
+   g_frameFrees.fetch_add(1, std::memory_order_relaxed);
+   g_frameBytesFreed.fetch_add(size, std::memory_order_relaxed);
+   g_liveBytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+uint32_t Cypher::MemoryProfiler::RegisterScope(const char* name)
+{
+   std::lock_guard<std::mutex> lock(g_registerLock);
+
+   uint32_t count = g_scopeCount.load(std::memory_order_relaxed);
+   for (uint32_t tag = 1; tag < count; ++tag)
+   {
+      if (std::strcmp(g_scopes[tag].name.load(std::memory_order_relaxed), name) == 0)
+         return tag;
+   }
+
+   // Past the limit, further scopes are folded into the untagged bucket rather than failing
+   if (count == MAX_SCOPES)
+      return UNTAGGED;
+
+   g_scopes[count].name.store(name, std::memory_order_release);
+   g_scopeCount.store(count + 1, std::memory_order_release);
+   return count;
+}
+
+uint32_t Cypher::MemoryProfiler::GetCurrentScope()
+{
+   return t_scope;
+}
+
+uint32_t Cypher::MemoryProfiler::SetCurrentScope(uint32_t tag)
+{
+   Assert(tag < MAX_SCOPES);
+   uint32_t previous = t_scope;
+   t_scope = tag;
+   return previous;
+}
+
+Cypher::MemoryFrameStats Cypher::MemoryProfiler::EndFrame()
+{
+   std::lock_guard<std::mutex> lock(g_frameLock);
+
+   MemoryFrameStats stats;
+   stats.frame = g_frameCount++;
+   stats.counters.allocations = g_frameAllocations.exchange(0, std::memory_order_relaxed);
+   stats.counters.frees = g_frameFrees.exchange(0, std::memory_order_relaxed);
+   stats.counters.bytesAllocated = g_frameBytesAllocated.exchange(0, std::memory_order_relaxed);
+   stats.counters.bytesFreed = g_frameBytesFreed.exchange(0, std::memory_order_relaxed);
+   stats.liveBytes = g_liveBytes.load(std::memory_order_relaxed);
+
+   // The next frame's peak starts from what is live now, not from zero
+   stats.peakLiveBytes = std::max(g_framePeakLiveBytes.exchange(stats.liveBytes, std::memory_order_relaxed), stats.liveBytes);
+
+   g_history[stats.frame % HISTORY_SIZE] = stats;
+   if (stats.frame == 0 || stats.counters.allocations > g_peakFrame.counters.allocations)
+      g_peakFrame = stats;
+   g_peakLiveBytes = std::max(g_peakLiveBytes, stats.peakLiveBytes);
+
+   uint32_t count = g_scopeCount.load(std::memory_order_acquire);
+   for (uint32_t tag = 0; tag < count; ++tag)
+   {
+      ScopeSlot& slot = g_scopes[tag];
+      slot.lastFrameAllocations = slot.frameAllocations.exchange(0, std::memory_order_relaxed);
+      slot.lastFrameBytes = slot.frameBytes.exchange(0, std::memory_order_relaxed);
+      slot.allocations += slot.lastFrameAllocations;
+      slot.bytesAllocated += slot.lastFrameBytes;
+      slot.peakFrameAllocations = std::max(slot.peakFrameAllocations, slot.lastFrameAllocations);
+      slot.peakFrameBytes = std::max(slot.peakFrameBytes, slot.lastFrameBytes);
+   }
+
+   return stats;
+}
+
+Cypher::AllocationCounters Cypher::MemoryProfiler::GetThreadCounters()
+{
+   return t_counters;
+}
+
+Cypher::MemoryFrameStats Cypher::MemoryProfiler::GetLastFrame()
+{
+   std::lock_guard<std::mutex> lock(g_frameLock);
+   return g_frameCount ? g_history[(g_frameCount - 1) % HISTORY_SIZE] : MemoryFrameStats();
+}
+
+Cypher::MemoryFrameStats Cypher::MemoryProfiler::GetPeakFrame()
+{
+   std::lock_guard<std::mutex> lock(g_frameLock);
+   return g_peakFrame;
+}
+
+size_t Cypher::MemoryProfiler::GetPeakLiveBytes()
+{
+   std::lock_guard<std::mutex> lock(g_frameLock);
+   return g_peakLiveBytes;
+}
+
+Cypher::MemoryScopeStats Cypher::MemoryProfiler::GetScopeStats(uint32_t tag)
+{
+   Assert(tag < GetScopeCount());
+   std::lock_guard<std::mutex> lock(g_frameLock);
+   return GetScopeStatsLocked(tag);
+}
+
+size_t Cypher::MemoryProfiler::GetScopeCount()
+{
+   return g_scopeCount.load(std::memory_order_acquire);
+}
+
+size_t Cypher::MemoryProfiler::GetHistory(std::span<MemoryFrameStats> out)
+{
+   std::lock_guard<std::mutex> lock(g_frameLock);
+
+   size_t count = static_cast<size_t>(std::min<uint64_t>({ g_frameCount, HISTORY_SIZE, out.size() }));
+   uint64_t first = g_frameCount - count;
+   for (size_t i = 0; i < count; ++i)
+      out[i] = g_history[(first + i) % HISTORY_SIZE];
+   return count;
+}
+
+void Cypher::MemoryProfiler::LogReport()
+{
+   MemoryFrameStats last = GetLastFrame();
+   MemoryFrameStats peak = GetPeakFrame();
+   size_t peakLive = GetPeakLiveBytes();
+
+   LOG_INFO("Memory frame {}: {} allocations ({} B), {} frees ({} B), live: {} B, frame peak: {} B",
+      last.frame, last.counters.allocations, last.counters.bytesAllocated, last.counters.frees, last.counters.bytesFreed,
+      last.liveBytes, last.peakLiveBytes);
+   LOG_INFO("Memory high-water: frame {} with {} allocations ({} B), peak live: {} B",
+      peak.frame, peak.counters.allocations, peak.counters.bytesAllocated, peakLive);
+
+   for (uint32_t tag = 0; tag < GetScopeCount(); ++tag)
+   {
+      MemoryScopeStats scope = GetScopeStats(tag);
+      if (scope.allocations == 0)
+         continue;
+
+      LOG_INFO("Memory scope [{}] last frame: {} ({} B), peak frame: {} ({} B), total: {} ({} B)",
+         scope.name, scope.frameAllocations, scope.frameBytes, scope.peakFrameAllocations, scope.peakFrameBytes,
+         scope.allocations, scope.bytesAllocated);
+   }
+}
+
+bool Cypher::MemoryProfiler::DumpToFile(const char* path)
+{
+   std::vector<MemoryFrameStats> history(HISTORY_SIZE);
+   history.resize(GetHistory(history));
+
+   std::ofstream file(path, std::ios::out | std::ios::trunc);
+   if (!file)
+      return false;
+
+   file << "scope,allocations,bytes,frame_allocations,frame_bytes,peak_frame_allocations,peak_frame_bytes\n";
+   for (uint32_t tag = 0; tag < GetScopeCount(); ++tag)
+   {
+      MemoryScopeStats scope = GetScopeStats(tag);
+      file << scope.name << ',' << scope.allocations << ',' << scope.bytesAllocated << ',' << scope.frameAllocations << ','
+           << scope.frameBytes << ',' << scope.peakFrameAllocations << ',' << scope.peakFrameBytes << '\n';
+   }
+
+   file << "\nframe,allocations,frees,bytes_allocated,bytes_freed,live_bytes,peak_live_bytes\n";
+   for (const MemoryFrameStats& frame : history)
+   {
+      file << frame.frame << ',' << frame.counters.allocations << ',' << frame.counters.frees << ','
+           << frame.counters.bytesAllocated << ',' << frame.counters.bytesFreed << ',' << frame.liveBytes << ','
+           << frame.peakLiveBytes << '\n';
+   }
+
+   return static_cast<bool>(file);
+}
+
+void Cypher::MemoryProfiler::Reset()
+{
+   std::lock_guard<std::mutex> lock(g_frameLock);
+
+   g_frameAllocations.store(0, std::memory_order_relaxed);
+   g_frameFrees.store(0, std::memory_order_relaxed);
+   g_frameBytesAllocated.store(0, std::memory_order_relaxed);
+   g_frameBytesFreed.store(0, std::memory_order_relaxed);
+   g_framePeakLiveBytes.store(g_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+   g_frameCount = 0;
+   g_peakFrame = MemoryFrameStats();
+   g_peakLiveBytes = 0;
+
+   for (ScopeSlot& slot : g_scopes)
+   {
+      slot.frameAllocations.store(0, std::memory_order_relaxed);
+      slot.frameBytes.store(0, std::memory_order_relaxed);
+      slot.allocations = 0;
+      slot.bytesAllocated = 0;
+      slot.lastFrameAllocations = 0;
+      slot.lastFrameBytes = 0;
+      slot.peakFrameAllocations = 0;
+      slot.peakFrameBytes = 0;
+   }
+}
+
+#ifdef CYPHER_TRACK_ALLOCATIONS
+// Replacement global operator new/delete. Each block carries a header just below the returned pointer holding the
+// requested size and the pointer malloc returned, so every form of delete can report the size and free the block.
+namespace
+{
+   struct AllocationHeader
+   {
+      void* block;
+      size_t size;
+   };
+
+   void* TrackedAllocate(size_t size, size_t alignment) noexcept
+   {
+      alignment = std::max(alignment, alignof(AllocationHeader));
+      void* block = std::malloc(size + alignment + sizeof(AllocationHeader));
+      if (!block)
+         return nullptr;
+
+      uintptr_t start = reinterpret_cast<uintptr_t>(block) + sizeof(AllocationHeader);
+      uintptr_t aligned = (start + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+      AllocationHeader* header = reinterpret_cast<AllocationHeader*>(aligned) - 1;
+      header->block = block;
+      header->size = size;
+
+      MemoryProfiler::RecordAllocation(size);
+      return reinterpret_cast<void*>(aligned);
+   }
+
+   void* TrackedAllocateOrThrow(size_t size, size_t alignment)
+   {
+      void* pointer = TrackedAllocate(size, alignment);
+      if (!pointer)
+         throw std::bad_alloc();
+      return pointer;
+   }
+
+   void TrackedFree(void* pointer) noexcept
+   {
+      if (!pointer)
+         return;
+
+      AllocationHeader* header = static_cast<AllocationHeader*>(pointer) - 1;
+      MemoryProfiler::RecordFree(header->size);
+      std::free(header->block);
+   }
+
+   constexpr size_t DEFAULT_NEW_ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+}
+
+void* operator new(size_t size) { return TrackedAllocateOrThrow(size, DEFAULT_NEW_ALIGNMENT); }
+void* operator new[](size_t size) { return TrackedAllocateOrThrow(size, DEFAULT_NEW_ALIGNMENT); }
+void* operator new(size_t size, std::align_val_t alignment) { return TrackedAllocateOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return TrackedAllocateOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return TrackedAllocate(size, DEFAULT_NEW_ALIGNMENT); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return TrackedAllocate(size, DEFAULT_NEW_ALIGNMENT); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return TrackedAllocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return TrackedAllocate(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* pointer) noexcept { TrackedFree(pointer); }
+void operator delete[](void* pointer) noexcept { TrackedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { TrackedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { TrackedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { TrackedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { TrackedFree(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { TrackedFree(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { TrackedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { TrackedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { TrackedFree(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { TrackedFree(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { TrackedFree(pointer); }
+#endif
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "Common.h"
+
+namespace Cypher
+{
+   struct AllocationCounters
+   {
+      uint64_t allocations = 0;
+      uint64_t frees = 0;
+      uint64_t bytesAllocated = 0;
+      uint64_t bytesFreed = 0;
+   };
+
+   struct MemoryFrameStats
+   {
+      uint64_t frame = 0;
+      AllocationCounters counters;
+      size_t liveBytes = 0;      // Bytes live at the end of the frame
+      size_t peakLiveBytes = 0;  // Most bytes live at any point during the frame
+   };
+
+   struct MemoryScopeStats
+   {
+      const char* name = nullptr;
+      uint64_t allocations = 0;        // Totals since startup
+      uint64_t bytesAllocated = 0;
+      uint64_t frameAllocations = 0;   // Last completed frame
+      uint64_t frameBytes = 0;
+      uint64_t peakFrameAllocations = 0;
+      uint64_t peakFrameBytes = 0;
+   };
+
+   // Opt-in allocation tracking, compiled in with CYPHER_TRACK_ALLOCATIONS (premake --track-allocations). Global operator
+   // new/delete and the jemalloc path of Memory are routed through RecordAllocation/RecordFree, which count per thread,
+   // per frame and per tagged scope. Scopes only attribute allocations; frees are counted against the frame alone, since
+   // memory is often released far from where it was requested.
+   class MemoryProfiler
+   {
+   public:
+#ifdef CYPHER_TRACK_ALLOCATIONS
+      static constexpr bool ENABLED = true;
+#else
+      static constexpr bool ENABLED = false;
+#endif
+      static constexpr size_t MAX_SCOPES = 64;
+      static constexpr size_t HISTORY_SIZE = 600;
+      static constexpr uint32_t UNTAGGED = 0;
+
+      static void RecordAllocation(size_t size);
+      static void RecordFree(size_t size);
+
+      // Returns a stable tag for a scope name, registering it on first use. Names are compared by content and must
+      // outlive the profiler, which string literals do.
+      static uint32_t RegisterScope(const char* name);
+      static uint32_t GetCurrentScope();
+      static uint32_t SetCurrentScope(uint32_t tag);
+
+      // Closes the current frame, folds its counters into the history and high-water marks, and returns them.
+      static MemoryFrameStats EndFrame();
+
+      // Counters of the calling thread since it started; diff two readings to assert a call does not allocate.
+      static AllocationCounters GetThreadCounters();
+
+      static MemoryFrameStats GetLastFrame();
+      static MemoryFrameStats GetPeakFrame();   // Frame with the most allocations so far
+      static size_t GetPeakLiveBytes();
+      static MemoryScopeStats GetScopeStats(uint32_t tag);
+      static size_t GetScopeCount();
+
+      // Copies up to out.size() of the most recent frames, oldest first, and returns how many were written.
+      static size_t GetHistory(std::span<MemoryFrameStats> out);
+
+      static void LogReport();
+      static bool DumpToFile(const char* path);
+      static void Reset();
+
+   private:
+      MemoryProfiler() = delete;
+   };
+
+   // Attributes allocations on this thread to a tag until destroyed, restoring the enclosing scope afterwards.
+   class MemoryScope
+   {
+   public:
+      explicit MemoryScope(uint32_t tag) :
+         m_previous(MemoryProfiler::SetCurrentScope(tag))
+      {}
+
+      ~MemoryScope() { MemoryProfiler::SetCurrentScope(m_previous); }
+
+      MemoryScope(const MemoryScope&) = delete;
+      MemoryScope& operator=(const MemoryScope&) = delete;
+
+   private:
+      uint32_t m_previous;
+   };
+}
+
+#ifdef CYPHER_TRACK_ALLOCATIONS
+   #define CYPHER_MEMORY_SCOPE(name) \
+      static const uint32_t CONCAT(s_memoryScopeTag, __LINE__) = Cypher::MemoryProfiler::RegisterScope(name); \
+      Cypher::MemoryScope CONCAT(memoryScope, __LINE__)(CONCAT(s_memoryScopeTag, __LINE__))
+   #define CYPHER_MEMORY_END_FRAME() Cypher::MemoryProfiler::EndFrame()
+#else
+   #define CYPHER_MEMORY_SCOPE(name)
+   #define CYPHER_MEMORY_END_FRAME()
+#endif
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+// Console types the renderer and the console loop are written against. On Windows they come from the Windows headers;
+// elsewhere the few in use are defined here with the same sizes and layout, so a cell buffer means the same thing on
+// every platform and only the code that presents it differs.
+#ifdef _WIN32
+   #include <Windows.h>
+#else
+   #include <cstdint>
+
+   using SHORT = int16_t;
+   using WORD = uint16_t;
+   using DWORD = uint32_t;
+   using BOOL = int;
+   using WCHAR = char16_t;
+   using HANDLE = void*;
+
+   #ifndef TRUE
+      #define TRUE 1
+   #endif
+   #ifndef FALSE
+      #define FALSE 0
+   #endif
+
+   struct COORD
+   {
+      SHORT X;
+      SHORT Y;
+   };
+
+   struct SMALL_RECT
+   {
+      SHORT Left;
+      SHORT Top;
+      SHORT Right;
+      SHORT Bottom;
+   };
+
+   struct CHAR_INFO
+   {
+      union
+      {
+         WCHAR UnicodeChar;
+         char AsciiChar;
+      } Char;
+      WORD Attributes;
+   };
+
+   // Attribute bits beyond the two colour nibbles, as in the Windows console
+   constexpr WORD COMMON_LVB_REVERSE_VIDEO = 0x4000;
+   constexpr WORD COMMON_LVB_UNDERSCORE = 0x8000;
+#endif
+
+// Shared libraries loaded at run time, such as the module Loom hosts: LoadLibrary and GetProcAddress on Windows, dlopen
+// and dlsym elsewhere.
+#ifndef _WIN32
+   #include <dlfcn.h>
+#endif
+
+namespace Cypher
+{
+#ifdef _WIN32
+   using ModuleHandle = HMODULE;
+#else
+   using ModuleHandle = void*;
+#endif
+
+   namespace Platform
+   {
+      // File name of a shared library built from a project named name, e.g. Game.dll or libGame.so.
+      inline std::wstring GetLibraryFileName(const std::wstring& name)
+      {
+#ifdef _WIN32
+         return name + L".dll";
+#else
+         return L"lib" + name + L".so";
+#endif
+      }
+
+      inline ModuleHandle OpenModule(const std::wstring& path)
+      {
+#ifdef _WIN32
+         return LoadLibraryW(path.c_str());
+#else
+         return dlopen(std::filesystem::path(path).c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+      }
+
+      inline void CloseModule(ModuleHandle module)
+      {
+#ifdef _WIN32
+         FreeLibrary(module);
+#else
+         dlclose(module);
+#endif
+      }
+
+      inline void* GetModuleSymbol(ModuleHandle module, const char* name)
+      {
+#ifdef _WIN32
+         return reinterpret_cast<void*>(GetProcAddress(module, name));
+#else
+         return dlsym(module, name);
+#endif
+      }
+
+      // Describes why the last module call on this thread failed.
+      inline std::string GetModuleError()
+      {
+#ifdef _WIN32
+         return "error code " + std::to_string(GetLastError());
+#else
+         const char* error = dlerror();
+         return error ? error : "unknown error";
+#endif
+      }
+   }
+}
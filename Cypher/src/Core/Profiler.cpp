@@ -0,0 +1,152 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+   using Cypher::ProfileEvent;
+   using Cypher::Profiler;
+
+   struct ThreadRing
+   {
+      std::array<ProfileEvent, Profiler::RING_CAPACITY> events;
+      std::atomic<uint64_t> head = 0;   // Total events ever written; the slot is head % RING_CAPACITY
+      std::atomic<const char*> name = nullptr;
+      uint32_t id = 0;
+      uint32_t depth = 0;               // Only touched by the owning thread
+   };
+
+   // Rings are registered once per thread and never freed, so events from threads that have exited can still be dumped.
+   struct RingRegistry
+   {
+      std::mutex lock;
+      std::vector<ThreadRing*> rings;
+   };
+
+   RingRegistry& GetRegistry()
+   {
+      static RingRegistry* registry = new RingRegistry();
+      return *registry;
+   }
+
+   ThreadRing& GetThreadRing()
+   {
+      thread_local ThreadRing* ring = nullptr;
+      if (!ring)
+      {
+         RingRegistry& registry = GetRegistry();
+         std::lock_guard<std::mutex> lock(registry.lock);
+         ring = new ThreadRing();
+         ring->id = static_cast<uint32_t>(registry.rings.size());
+         registry.rings.push_back(ring);
+      }
+      return *ring;
+   }
+
+   // Copies the events still held by a ring, oldest first. Slots the owner may have overwritten during the copy are
+   // dropped by re-reading the head afterwards.
+   void CopyEvents(const ThreadRing& ring, std::vector<ProfileEvent>& out)
+   {
+      uint64_t head = ring.head.load(std::memory_order_acquire);
+      uint64_t first = head > Profiler::RING_CAPACITY ? head - Profiler::RING_CAPACITY : 0;
+
+      size_t start = out.size();
+      for (uint64_t i = first; i < head; ++i)
+         out.push_back(ring.events[i % Profiler::RING_CAPACITY]);
+
+      uint64_t overwritten = ring.head.load(std::memory_order_acquire);
+      uint64_t valid = overwritten > Profiler::RING_CAPACITY ? overwritten - Profiler::RING_CAPACITY : 0;
+      if (valid > first)
+         out.erase(out.begin() + start, out.begin() + start + static_cast<size_t>(std::min(valid - first, head - first)));
+   }
+
+   void WriteEscaped(std::ofstream& file, const char* text)
+   {
+      for (; *text; ++text)
+      {
+         char c = *text;
+         if (c == '"' || c == '\\')
+            file << '\\' << c;
+         else if (static_cast<unsigned char>(c) >= 0x20)
+            file << c;
+      }
+   }
+}
+
+std::chrono::steady_clock::time_point Cypher::Profiler::GetEpoch()
+{
+   static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+   return epoch;
+}
+
+uint32_t Cypher::Profiler::Begin()
+{
+   return GetThreadRing().depth++;
+}
+
+void Cypher::Profiler::End(const char* name, uint64_t begin, uint32_t depth)
+{
+   ThreadRing& ring = GetThreadRing();
+   ring.depth = depth;
+
+   // Single writer: fill the slot, then publish it by advancing the head
+   uint64_t head = ring.head.load(std::memory_order_relaxed);
+   ring.events[head % RING_CAPACITY] = { name, begin, Now(), depth };
+   ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Cypher::Profiler::SetThreadName(const char* name)
+{
+   GetThreadRing().name.store(name, std::memory_order_release);
+}
+
+bool Cypher::Profiler::WriteChromeTrace(const char* path)
+{
+   std::vector<ThreadRing*> rings;
+   {
+      RingRegistry& registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.lock);
+      rings = registry.rings;
+   }
+
+   std::ofstream file(path, std::ios::out | std::ios::trunc);
+   if (!file)
+      return false;
+
+   // Chrome expects microseconds; fractional values keep nanosecond precision
+   file << std::fixed << std::setprecision(3);
+   file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+   bool first = true;
+   std::vector<ProfileEvent> events;
+   for (const ThreadRing* ring : rings)
+   {
+      if (const char* name = ring->name.load(std::memory_order_acquire))
+      {
+         file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << ring->id
+              << ",\"args\":{\"name\":\"";
+         WriteEscaped(file, name);
+         file << "\"}}";
+         first = false;
+      }
+
+      events.clear();
+      CopyEvents(*ring, events);
+      for (const ProfileEvent& event : events)
+      {
+         file << (first ? "" : ",") << "\n{\"name\":\"";
+         WriteEscaped(file, event.name);
+         file << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << ring->id
+              << ",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << (event.end - event.begin) / 1000.0 << '}';
+         first = false;
+      }
+   }
+   file << "\n]}\n";
+
+   return static_cast<bool>(file);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "Common.h"
+
+namespace Cypher
+{
+   struct ProfileEvent
+   {
+      const char* name = nullptr;
+      uint64_t begin = 0;   // Nanoseconds since the profiler started
+      uint64_t end = 0;
+      uint32_t depth = 0;   // Nesting level on the recording thread
+   };
+
+   // Scoped CPU profiler, compiled in with CYPHER_PROFILE (premake --profile). Every thread records finished scopes into
+   // its own ring buffer; the owning thread is the only writer, so recording takes no lock and only publishes an index.
+   // Once a ring is full the oldest events are overwritten, so a dump always covers the most recent stretch of frames.
+   class Profiler
+   {
+   public:
+#ifdef CYPHER_PROFILE
+      static constexpr bool ENABLED = true;
+#else
+      static constexpr bool ENABLED = false;
+#endif
+      static constexpr size_t RING_CAPACITY = 1 << 16;
+
+      static inline uint64_t Now()
+      {
+         return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - GetEpoch()).count());
+      }
+
+      // Opens a scope on the calling thread and returns its depth; the matching End records the event.
+      static uint32_t Begin();
+      static void End(const char* name, uint64_t begin, uint32_t depth);
+
+      // Names the calling thread in exported traces. The string must outlive the profiler.
+      static void SetThreadName(const char* name);
+
+      // Writes the events still held by every thread as Chrome trace_event JSON, viewable in chrome://tracing or Perfetto.
+      static bool WriteChromeTrace(const char* path);
+
+   private:
+      Profiler() = delete;
+
+      static std::chrono::steady_clock::time_point GetEpoch();
+   };
+
+   class ProfileScope
+   {
+   public:
+      explicit ProfileScope(const char* name) :
+         m_name(name),
+         m_depth(Profiler::Begin()),
+         m_begin(Profiler::Now())
+      {}
+
+      ~ProfileScope() { Profiler::End(m_name, m_begin, m_depth); }
+
+      ProfileScope(const ProfileScope&) = delete;
+      ProfileScope& operator=(const ProfileScope&) = delete;
+
+   private:
+      const char* m_name;
+      uint32_t m_depth;
+      uint64_t m_begin;
+   };
+}
+
+#ifdef CYPHER_PROFILE
+   #define CYPHER_PROFILE_SCOPE(name) Cypher::ProfileScope CONCAT(profileScope, __LINE__)(name)
+   #define CYPHER_PROFILE_FUNCTION() CYPHER_PROFILE_SCOPE(__FUNCTION__)
+   #define CYPHER_PROFILE_THREAD(name) Cypher::Profiler::SetThreadName(name)
+   #define CYPHER_PROFILE_DUMP(path) Cypher::Profiler::WriteChromeTrace(path)
+#else
+   #define CYPHER_PROFILE_SCOPE(name)
+   #define CYPHER_PROFILE_FUNCTION()
+   #define CYPHER_PROFILE_THREAD(name)
+   #define CYPHER_PROFILE_DUMP(path)
+#endif
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "Common.h"
+
+namespace Cypher
+{
+   // Hands immutable state from one producer thread to one consumer thread without locks or copies. It is a triple
+   // buffer (the producer's back slot, a ready slot and the consumer's current slot) with a fourth slot holding the
+   // consumer's previous snapshot, so a renderer can interpolate between the last two simulation steps while the
+   // simulation keeps writing. Publishing never waits on the consumer; snapshots the consumer does not get to are skipped.
+   template<typename T>
+   class SnapshotBuffer
+   {
+   public:
+      using Clock = std::chrono::steady_clock;
+
+      struct Snapshot
+      {
+         T state = {};
+         uint64_t step = 0;       // Publish count when this snapshot was published, starting from 1
+         Clock::time_point time;  // When it was published
+      };
+
+      SnapshotBuffer() :
+         m_ready(READY_SLOT),
+         m_back(BACK_SLOT),
+         m_published(0),
+         m_current(CURRENT_SLOT),
+         m_previous(PREVIOUS_SLOT)
+      {}
+
+      SnapshotBuffer(const SnapshotBuffer&) = delete;
+      SnapshotBuffer& operator=(const SnapshotBuffer&) = delete;
+
+      // Producer: the state to fill in for the next Publish. It holds whatever was in the slot last time around, so
+      // callers either overwrite it completely or keep their own copy and assign it.
+      inline T& Write() { return m_slots[m_back].snapshot.state; }
+
+      void Publish()
+      {
+         Snapshot& snapshot = m_slots[m_back].snapshot;
+         snapshot.step = ++m_published;
+         snapshot.time = Clock::now();
+         m_back = m_ready.exchange(m_back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+      }
+
+      // Consumer: takes the newest published snapshot, moving the current one to previous. Returns false, leaving both
+      // untouched, if nothing new has been published.
+      bool Acquire()
+      {
+         if (!(m_ready.load(std::memory_order_acquire) & FRESH))
+            return false;
+
+         uint32_t newest = m_ready.exchange(m_previous, std::memory_order_acq_rel) & INDEX_MASK;
+         m_previous = m_current;
+         m_current = newest;
+         return true;
+      }
+
+      inline const Snapshot& Current() const { return m_slots[m_current].snapshot; }
+      inline const Snapshot& Previous() const { return m_slots[m_previous].snapshot; }
+
+      // How far the consumer is from Current towards the next step, for blending Previous into Current. Rendering
+      // with this lags the simulation by one step, which is what lets it stay smooth at any frame rate.
+      float Alpha(Clock::duration step, Clock::time_point now = Clock::now()) const
+      {
+         if (Current().step == 0 || step <= Clock::duration::zero())
+            return 1.0f;
+
+         float alpha = std::chrono::duration<float>(now - Current().time) / std::chrono::duration<float>(step);
+         return std::clamp(alpha, 0.0f, 1.0f);
+      }
+
+   private:
+      static constexpr uint32_t BACK_SLOT = 0;
+      static constexpr uint32_t READY_SLOT = 1;
+      static constexpr uint32_t CURRENT_SLOT = 2;
+      static constexpr uint32_t PREVIOUS_SLOT = 3;
+      static constexpr uint32_t INDEX_MASK = 0x3;
+      static constexpr uint32_t FRESH = 0x4;
+
+      struct alignas(64) Slot
+      {
+         Snapshot snapshot;
+      };
+
+      std::array<Slot, 4> m_slots;
+      alignas(64) std::atomic<uint32_t> m_ready;
+
+      // Producer side
+      alignas(64) uint32_t m_back;
+      uint64_t m_published;
+
+      // Consumer side
+      alignas(64) uint32_t m_current;
+      uint32_t m_previous;
+   };
+}
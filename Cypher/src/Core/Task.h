@@ -0,0 +1,204 @@
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "Common.h"
+#include "Core/Memory.h"
+
+namespace Cypher
+{
+   class TaskScheduler;
+
+   // Recycles coroutine frames through per-thread free lists, one per 64-byte size class, so spawning a behaviour
+   // allocates only until the pool has warmed up. Frames larger than MAX_POOLED_SIZE go straight to the heap.
+   class TaskFramePool
+   {
+   public:
+      static constexpr size_t GRANULARITY = 64;
+      static constexpr size_t MAX_POOLED_SIZE = 2048;
+
+      static void* Allocate(size_t size)
+      {
+         if (size > MAX_POOLED_SIZE)
+            return Memory::Allocate(size);
+
+         FreeLists& lists = GetFreeLists();
+         size_t sizeClass = GetSizeClass(size);
+         if (FreeBlock* block = lists.heads[sizeClass])
+         {
+            lists.heads[sizeClass] = block->next;
+            return block;
+         }
+         return Memory::Allocate((sizeClass + 1) * GRANULARITY);
+      }
+
+      static void Deallocate(void* frame, size_t size)
+      {
+         if (size > MAX_POOLED_SIZE)
+         {
+            Memory::Deallocate(frame, size);
+            return;
+         }
+
+         FreeLists& lists = GetFreeLists();
+         size_t sizeClass = GetSizeClass(size);
+         FreeBlock* block = static_cast<FreeBlock*>(frame);
+         block->next = lists.heads[sizeClass];
+         lists.heads[sizeClass] = block;
+      }
+
+   private:
+      static constexpr size_t CLASS_COUNT = MAX_POOLED_SIZE / GRANULARITY;
+
+      struct FreeBlock
+      {
+         FreeBlock* next;
+      };
+
+      struct FreeLists
+      {
+         std::array<FreeBlock*, CLASS_COUNT> heads = {};
+
+         ~FreeLists()
+         {
+            for (size_t sizeClass = 0; sizeClass < CLASS_COUNT; ++sizeClass)
+            {
+               while (FreeBlock* block = heads[sizeClass])
+               {
+                  heads[sizeClass] = block->next;
+                  Memory::Deallocate(block, (sizeClass + 1) * GRANULARITY);
+               }
+            }
+         }
+      };
+
+      static inline size_t GetSizeClass(size_t size) { return (size + GRANULARITY - 1) / GRANULARITY - 1; }
+
+      static FreeLists& GetFreeLists()
+      {
+         thread_local FreeLists lists;
+         return lists;
+      }
+   };
+
+   // State shared by every Task promise. A task started by TaskScheduler::Spawn is a root: it is linked into the
+   // scheduler's list of running tasks and frees itself when it finishes. A task awaited by another resumes its awaiter
+   // when it finishes and is freed by the Task object that owns it.
+   struct TaskPromiseBase
+   {
+      std::coroutine_handle<> continuation;
+      TaskScheduler* scheduler = nullptr;
+      TaskPromiseBase* previousRoot = nullptr;
+      TaskPromiseBase* nextRoot = nullptr;
+
+      static void* operator new(size_t size) { return TaskFramePool::Allocate(size); }
+      static void operator delete(void* frame, size_t size) { TaskFramePool::Deallocate(frame, size); }
+
+      struct FinalAwaiter
+      {
+         inline bool await_ready() const noexcept { return false; }
+
+         template<typename Promise>
+         std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept { return handle.promise().Finish(handle); }
+
+         inline void await_resume() const noexcept {}
+      };
+
+      inline std::suspend_always initial_suspend() const noexcept { return {}; }
+      inline FinalAwaiter final_suspend() const noexcept { return {}; }
+      inline void unhandled_exception() const noexcept { std::terminate(); }
+
+      // Picks the coroutine to run once this one has finished. Defined in TaskScheduler.cpp.
+      std::coroutine_handle<> Finish(std::coroutine_handle<> self) noexcept;
+   };
+
+   template<typename T>
+   struct TaskPromise : TaskPromiseBase
+   {
+      std::optional<T> value;
+
+      template<typename U>
+      void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+   };
+
+   template<>
+   struct TaskPromise<void> : TaskPromiseBase
+   {
+      inline void return_void() const noexcept {}
+   };
+
+   // Coroutine returning T. Tasks start suspended: awaiting one from another task runs it to completion and yields its
+   // result, while TaskScheduler::Spawn runs a Task<void> as an independent behaviour resumed from the frame loop.
+   template<typename T = void>
+   class [[nodiscard]] Task
+   {
+   public:
+      struct promise_type : TaskPromise<T>
+      {
+         inline Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+      };
+
+      using Handle = std::coroutine_handle<promise_type>;
+
+      Task() = default;
+      explicit Task(Handle handle) : m_handle(handle) {}
+
+      Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+      Task& operator=(Task&& other) noexcept
+      {
+         if (this != &other)
+         {
+            if (m_handle)
+               m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+         }
+         return *this;
+      }
+
+      Task(const Task&) = delete;
+      Task& operator=(const Task&) = delete;
+
+      ~Task()
+      {
+         if (m_handle)
+            m_handle.destroy();
+      }
+
+      inline bool IsValid() const { return static_cast<bool>(m_handle); }
+      inline bool IsDone() const { return m_handle && m_handle.done(); }
+
+      // Hands the coroutine over, for TaskScheduler::Spawn.
+      inline Handle Release() { return std::exchange(m_handle, nullptr); }
+
+      auto operator co_await() && noexcept
+      {
+         struct Awaiter
+         {
+            Handle handle;
+
+            inline bool await_ready() const noexcept { return !handle || handle.done(); }
+
+            inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+               handle.promise().continuation = awaiting;
+               return handle;
+            }
+
+            T await_resume()
+            {
+               if constexpr (!std::is_void_v<T>)
+                  return std::move(*handle.promise().value);
+            }
+         };
+         return Awaiter{ m_handle };
+      }
+
+   private:
+      Handle m_handle;
+   };
+}
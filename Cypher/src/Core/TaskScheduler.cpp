@@ -0,0 +1,188 @@
+#include "TaskScheduler.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace
+{
+   thread_local Cypher::TaskScheduler* t_currentScheduler = nullptr;
+
+   // Makes a scheduler current for the duration of a Tick, restoring whatever was current before.
+   struct CurrentSchedulerScope
+   {
+      Cypher::TaskScheduler* previous;
+
+      explicit CurrentSchedulerScope(Cypher::TaskScheduler* scheduler) : previous(t_currentScheduler) { t_currentScheduler = scheduler; }
+      ~CurrentSchedulerScope() { t_currentScheduler = previous; }
+   };
+}
+
+std::coroutine_handle<> Cypher::TaskPromiseBase::Finish(std::coroutine_handle<> self) noexcept
+{
+   if (continuation)
+      return continuation;
+
+   if (scheduler)
+      scheduler->Retire(*this, self);
+   return std::noop_coroutine();
+}
+
+Cypher::TaskScheduler::TaskScheduler() :
+   m_roots(nullptr),
+   m_runningCount(0),
+   m_time(0.0),
+   m_frame(0)
+{
+}
+
+Cypher::TaskScheduler::~TaskScheduler()
+{
+   StopAll();
+}
+
+Cypher::TaskScheduler* Cypher::TaskScheduler::GetCurrent()
+{
+   return t_currentScheduler;
+}
+
+void Cypher::TaskScheduler::Spawn(Task<> task)
+{
+   if (!task.IsValid())
+      return;
+
+   std::lock_guard<std::mutex> lock(m_spawnLock);
+   m_spawned.push_back(task.Release());
+}
+
+void Cypher::TaskScheduler::Tick(float deltaTime)
+{
+   CurrentSchedulerScope current(this);
+   m_time += deltaTime;
+   ++m_frame;
+
+   // Gather everything due before resuming anything, so a task that waits again during this Tick runs on the next one
+   m_resuming.swap(m_nextFrame);
+
+   while (!m_timers.empty() && m_timers.front().wakeTime <= m_time)
+   {
+      std::pop_heap(m_timers.begin(), m_timers.end(), std::greater<Timer>());
+      m_resuming.push_back(m_timers.back().handle);
+      m_timers.pop_back();
+   }
+
+   for (size_t i = 0; i < m_jobWaits.size();)
+   {
+      if (m_jobWaits[i].counter->IsDone())
+      {
+         m_resuming.push_back(m_jobWaits[i].handle);
+         m_jobWaits[i] = m_jobWaits.back();
+         m_jobWaits.pop_back();
+      }
+      else
+      {
+         ++i;
+      }
+   }
+
+   {
+      std::lock_guard<std::mutex> lock(m_spawnLock);
+      m_starting.swap(m_spawned);
+   }
+
+   for (std::coroutine_handle<> handle : m_starting)
+   {
+      auto root = std::coroutine_handle<Task<>::promise_type>::from_address(handle.address());
+      TaskPromiseBase& promise = root.promise();
+      promise.scheduler = this;
+      promise.nextRoot = m_roots;
+      if (m_roots)
+         m_roots->previousRoot = &promise;
+      m_roots = &promise;
+      ++m_runningCount;
+
+      m_resuming.push_back(handle);
+   }
+   m_starting.clear();
+
+   for (std::coroutine_handle<> handle : m_resuming)
+      handle.resume();
+   m_resuming.clear();
+}
+
+void Cypher::TaskScheduler::StopAll()
+{
+   for (const JobWait& wait : m_jobWaits)
+   {
+      while (!wait.counter->IsDone())
+         std::this_thread::yield();
+   }
+
+   m_nextFrame.clear();
+   m_timers.clear();
+   m_jobWaits.clear();
+
+   // Destroying a root destroys the Task objects in its frame, and with them any tasks it was awaiting
+   while (m_roots)
+   {
+      TaskPromiseBase* root = m_roots;
+      m_roots = root->nextRoot;
+      std::coroutine_handle<Task<>::promise_type>::from_promise(static_cast<Task<>::promise_type&>(*root)).destroy();
+   }
+   m_runningCount = 0;
+
+   std::lock_guard<std::mutex> lock(m_spawnLock);
+   for (std::coroutine_handle<> handle : m_spawned)
+      handle.destroy();
+   m_spawned.clear();
+}
+
+void Cypher::TaskScheduler::Retire(TaskPromiseBase& root, std::coroutine_handle<> handle)
+{
+   if (root.previousRoot)
+      root.previousRoot->nextRoot = root.nextRoot;
+   else
+      m_roots = root.nextRoot;
+   if (root.nextRoot)
+      root.nextRoot->previousRoot = root.previousRoot;
+
+   --m_runningCount;
+   handle.destroy();
+}
+
+void Cypher::TaskScheduler::WaitNextFrame(std::coroutine_handle<> handle)
+{
+   m_nextFrame.push_back(handle);
+}
+
+void Cypher::TaskScheduler::WaitUntil(double wakeTime, std::coroutine_handle<> handle)
+{
+   m_timers.push_back({ wakeTime, handle });
+   std::push_heap(m_timers.begin(), m_timers.end(), std::greater<Timer>());
+}
+
+void Cypher::TaskScheduler::WaitForCounter(const Symphony::JobCounter& counter, std::coroutine_handle<> handle)
+{
+   m_jobWaits.push_back({ &counter, handle });
+}
+
+void Cypher::NextFrame::await_suspend(std::coroutine_handle<> handle) const
+{
+   TaskScheduler* scheduler = TaskScheduler::GetCurrent();
+   Assert(scheduler);
+   scheduler->WaitNextFrame(handle);
+}
+
+void Cypher::Seconds::await_suspend(std::coroutine_handle<> handle) const
+{
+   TaskScheduler* scheduler = TaskScheduler::GetCurrent();
+   Assert(scheduler);
+   scheduler->WaitUntil(scheduler->GetTime() + duration, handle);
+}
+
+void Cypher::WaitForJobs::await_suspend(std::coroutine_handle<> handle) const
+{
+   TaskScheduler* scheduler = TaskScheduler::GetCurrent();
+   Assert(scheduler);
+   scheduler->WaitForCounter(counter, handle);
+}
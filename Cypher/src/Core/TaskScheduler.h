@@ -0,0 +1,166 @@
+#pragma once
+
+#include <coroutine>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Common.h"
+#include "Core/Task.h"
+#include "ECS/JobSystem.h"
+
+namespace Cypher
+{
+   // Resumes suspended tasks from the frame loop. Tasks only ever run inside Spawn's first Tick and later Ticks, on the
+   // thread calling Tick; the awaitables below find the scheduler to suspend on through GetCurrent. Waiting tasks sit
+   // in vectors that keep their capacity, so once those have grown suspending and resuming allocate nothing.
+   class TaskScheduler
+   {
+   public:
+      TaskScheduler();
+      ~TaskScheduler();
+
+      TaskScheduler(const TaskScheduler&) = delete;
+      TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+      // Takes ownership of the task and starts it on the next Tick. Safe to call from any thread.
+      void Spawn(Task<> task);
+
+      // Advances scheduler time and resumes every task whose wait is over.
+      void Tick(float deltaTime);
+
+      // Destroys every running task, along with any task it is awaiting. Blocks until jobs tasks are waiting on finish,
+      // since those may still reference the task frames.
+      void StopAll();
+
+      inline double GetTime() const { return m_time; }
+      inline uint64_t GetFrame() const { return m_frame; }
+      inline size_t GetRunningCount() const { return m_runningCount; }
+
+      // The scheduler running tasks on this thread, or null outside of Tick.
+      static TaskScheduler* GetCurrent();
+
+   private:
+      friend struct TaskPromiseBase;
+      friend struct NextFrame;
+      friend struct Seconds;
+      friend struct WaitForJobs;
+
+      struct Timer
+      {
+         double wakeTime;
+         std::coroutine_handle<> handle;
+
+         inline bool operator>(const Timer& other) const { return wakeTime > other.wakeTime; }
+      };
+
+      struct JobWait
+      {
+         const Symphony::JobCounter* counter;
+         std::coroutine_handle<> handle;
+      };
+
+      void Retire(TaskPromiseBase& root, std::coroutine_handle<> handle);
+      void WaitNextFrame(std::coroutine_handle<> handle);
+      void WaitUntil(double wakeTime, std::coroutine_handle<> handle);
+      void WaitForCounter(const Symphony::JobCounter& counter, std::coroutine_handle<> handle);
+
+      std::mutex m_spawnLock;
+      std::vector<std::coroutine_handle<>> m_spawned;
+
+      std::vector<std::coroutine_handle<>> m_nextFrame;
+      std::vector<Timer> m_timers;                      // Min-heap on wake time
+      std::vector<JobWait> m_jobWaits;
+      std::vector<std::coroutine_handle<>> m_resuming;  // Scratch list for Tick
+      std::vector<std::coroutine_handle<>> m_starting;  // Scratch list for Tick
+
+      TaskPromiseBase* m_roots;
+      size_t m_runningCount;
+      double m_time;
+      uint64_t m_frame;
+   };
+
+   // co_await NextFrame() resumes the task on the next Tick.
+   struct NextFrame
+   {
+      inline bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> handle) const;
+      inline void await_resume() const noexcept {}
+   };
+
+   // co_await Seconds(x) resumes the task on the first Tick at least x seconds of scheduler time later.
+   struct Seconds
+   {
+      explicit Seconds(float seconds) : duration(seconds) {}
+
+      inline bool await_ready() const noexcept { return duration <= 0.0f; }
+      void await_suspend(std::coroutine_handle<> handle) const;
+      inline void await_resume() const noexcept {}
+
+      float duration;
+   };
+
+   // co_await WaitForJobs(counter) resumes the task on the first Tick after every job on the counter has finished.
+   struct WaitForJobs
+   {
+      explicit WaitForJobs(const Symphony::JobCounter& counter) : counter(counter) {}
+
+      inline bool await_ready() const noexcept { return counter.IsDone(); }
+      void await_suspend(std::coroutine_handle<> handle) const;
+      inline void await_resume() const noexcept {}
+
+      const Symphony::JobCounter& counter;
+   };
+
+   // co_await RunAsync(func) runs func on the job system and resumes the task with its result, back on the scheduler's
+   // thread, once it has finished. The job and its counter live in the awaiting coroutine's frame.
+   template<typename Func>
+   class RunAsync
+   {
+   public:
+      using Result = std::invoke_result_t<Func&>;
+
+      explicit RunAsync(Func function, Symphony::JobSystem& jobSystem = Symphony::JobSystem::GetDefault()) :
+         m_function(std::move(function)),
+         m_jobSystem(jobSystem)
+      {}
+
+      inline bool await_ready() const noexcept { return false; }
+
+      void await_suspend(std::coroutine_handle<> handle)
+      {
+         m_job.function = &RunAsync::Run;
+         m_job.context = this;
+         m_job.counter = &m_counter;
+         m_counter.Add(1);
+         m_jobSystem.Schedule(m_job);
+         WaitForJobs(m_counter).await_suspend(handle);
+      }
+
+      Result await_resume()
+      {
+         if constexpr (!std::is_void_v<Result>)
+            return std::move(*m_result);
+      }
+
+   private:
+      struct Empty {};
+
+      static void Run(void* context)
+      {
+         RunAsync& self = *static_cast<RunAsync*>(context);
+         if constexpr (std::is_void_v<Result>)
+            self.m_function();
+         else
+            self.m_result.emplace(self.m_function());
+      }
+
+      Func m_function;
+      Symphony::JobSystem& m_jobSystem;
+      Symphony::Job m_job;
+      Symphony::JobCounter m_counter;
+      std::conditional_t<std::is_void_v<Result>, Empty, std::optional<Result>> m_result;
+   };
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "../Core/Memory.h"
+#include "ComponentType.h"
+
+namespace Symphony
+{
+   // Stores every entity that has exactly the component set described by its mask. Entities live in fixed-size
+   // chunks laid out as structure-of-arrays: an entity column followed by one column per component type. Rows are
+   // kept packed, so every chunk but the last is full and a query can walk the columns linearly.
+   class Archetype
+   {
+   public:
+      static constexpr size_t CHUNK_SIZE = 16 * 1024;
+      static constexpr size_t CHUNK_ALIGNMENT = 64;
+
+      struct Column
+      {
+         const ComponentInfo* info;
+         size_t offset;
+      };
+
+      explicit Archetype(ComponentMask mask) :
+         m_mask(mask),
+         m_size(0),
+         m_chunkCapacity(0)
+      {
+         m_columnIndex.fill(NULL_COLUMN);
+
+         for (ComponentMask bits = mask; bits; bits &= bits - 1)
+         {
+            ComponentID id = static_cast<ComponentID>(std::countr_zero(bits));
+            m_columnIndex[id] = static_cast<uint8_t>(m_columns.size());
+            m_columns.push_back({ &ComponentRegistry::GetInfo(id), 0 });
+         }
+
+         ComputeLayout();
+      }
+
+      Archetype(const Archetype&) = delete;
+      Archetype& operator=(const Archetype&) = delete;
+
+      ~Archetype()
+      {
+         for (size_t row = 0; row < m_size; ++row)
+         {
+            for (const Column& column : m_columns)
+               column.info->destroy(GetCell(column, row));
+         }
+
+         for (std::byte* chunk : m_chunks)
+            Cypher::Memory::Deallocate(chunk, CHUNK_SIZE, CHUNK_ALIGNMENT, Cypher::MemoryArena::ECS);
+      }
+
+      inline ComponentMask GetMask() const { return m_mask; }
+      inline bool Has(ComponentID id) const { return (m_mask >> id) & 1; }
+      inline bool HasAll(ComponentMask mask) const { return (m_mask & mask) == mask; }
+
+      inline size_t Size() const { return m_size; }
+      inline size_t ChunkCapacity() const { return m_chunkCapacity; }
+      inline size_t ChunkCount() const { return (m_size + m_chunkCapacity - 1) / m_chunkCapacity; }
+      inline size_t ChunkSize(size_t chunk) const { return std::min(m_chunkCapacity, m_size - chunk * m_chunkCapacity); }
+
+      inline Entity* GetEntities(size_t chunk) { return reinterpret_cast<Entity*>(m_chunks[chunk]); }
+      inline const Entity* GetEntities(size_t chunk) const { return reinterpret_cast<const Entity*>(m_chunks[chunk]); }
+
+      inline void* GetColumn(size_t chunk, ComponentID id)
+      {
+         Assert(Has(id));
+         return m_chunks[chunk] + m_columns[m_columnIndex[id]].offset;
+      }
+
+      template<Component Comp>
+      inline Comp* GetColumn(size_t chunk) { return static_cast<Comp*>(GetColumn(chunk, ComponentRegistry::GetID<Comp>())); }
+
+      inline Entity GetEntity(size_t row) const { return GetEntities(row / m_chunkCapacity)[row % m_chunkCapacity]; }
+
+      inline void* GetComponent(size_t row, ComponentID id)
+      {
+         Assert(Has(id) && row < m_size);
+         return GetCell(m_columns[m_columnIndex[id]], row);
+      }
+
+      // Reserves a row for the entity. Component cells of the new row are left unconstructed.
+      size_t Allocate(Entity entity)
+      {
+         size_t row = m_size;
+         if (row / m_chunkCapacity == m_chunks.size())
+            m_chunks.push_back(static_cast<std::byte*>(Cypher::Memory::Allocate(CHUNK_SIZE, CHUNK_ALIGNMENT, Cypher::MemoryArena::ECS)));
+
+         GetEntities(row / m_chunkCapacity)[row % m_chunkCapacity] = entity;
+         ++m_size;
+         return row;
+      }
+
+      // Constructs every component of a freshly allocated row with its default value.
+      void ConstructRow(size_t row)
+      {
+         for (const Column& column : m_columns)
+            column.info->construct(GetCell(column, row));
+      }
+
+      // Destroys the row and fills the hole with the last row. Returns the entity now living at row, or NULL_ENTITY if the
+      // erased row was the last one.
+      Entity Erase(size_t row)
+      {
+         for (const Column& column : m_columns)
+            column.info->destroy(GetCell(column, row));
+
+         return FillHole(row);
+      }
+
+      // Moves the row into dst. Components both archetypes share are move-constructed, the ones dst lacks are destroyed and
+      // the ones only dst has are left unconstructed for the caller. Returns the entity now living at row in this archetype.
+      Entity MoveTo(size_t row, Archetype& dst, size_t& dstRow)
+      {
+         dstRow = dst.Allocate(GetEntity(row));
+
+         for (const Column& column : m_columns)
+         {
+            void* src = GetCell(column, row);
+            if (dst.Has(column.info->id))
+               column.info->moveConstruct(dst.GetCell(dst.m_columns[dst.m_columnIndex[column.info->id]], dstRow), src);
+            column.info->destroy(src);
+         }
+
+         return FillHole(row);
+      }
+
+   private:
+      static constexpr uint8_t NULL_COLUMN = 0xFF;
+
+      static constexpr size_t AlignUp(size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+      inline void* GetCell(const Column& column, size_t row)
+      {
+         return m_chunks[row / m_chunkCapacity] + column.offset + (row % m_chunkCapacity) * column.info->size;
+      }
+
+      Entity FillHole(size_t row)
+      {
+         size_t last = --m_size;
+         if (row == last)
+            return NULL_ENTITY;
+
+         Entity moved = GetEntity(last);
+         GetEntities(row / m_chunkCapacity)[row % m_chunkCapacity] = moved;
+
+         for (const Column& column : m_columns)
+         {
+            void* src = GetCell(column, last);
+            column.info->moveConstruct(GetCell(column, row), src);
+            column.info->destroy(src);
+         }
+
+         return moved;
+      }
+
+      // Picks the largest row count whose columns, each aligned to a cache line, still fit in one chunk.
+      void ComputeLayout()
+      {
+         size_t rowSize = sizeof(Entity);
+         for (const Column& column : m_columns)
+            rowSize += column.info->size;
+
+         for (size_t capacity = CHUNK_SIZE / rowSize; capacity > 0; --capacity)
+         {
+            size_t offset = AlignUp(capacity * sizeof(Entity), CHUNK_ALIGNMENT);
+            for (Column& column : m_columns)
+            {
+               offset = AlignUp(offset, std::max(column.info->alignment, CHUNK_ALIGNMENT));
+               column.offset = offset;
+               offset += capacity * column.info->size;
+            }
+
+            if (offset <= CHUNK_SIZE)
+            {
+               m_chunkCapacity = capacity;
+               return;
+            }
+         }
+
+         throw std::length_error("Archetype: component set does not fit in a single chunk.");
+      }
+
+      ComponentMask m_mask;
+      std::vector<Column> m_columns;
+      std::array<uint8_t, MAX_COMPONENTS> m_columnIndex;
+      std::vector<std::byte*> m_chunks;
+      size_t m_size;
+      size_t m_chunkCapacity;
+   };
+}
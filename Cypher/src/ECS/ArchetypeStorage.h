@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Archetype.h"
+
+namespace Symphony
+{
+   // Archetype storage backend: entities sharing a component set live together in SoA chunks, so a query over several
+   // component types walks each matching chunk linearly instead of doing one sparse lookup per component per entity.
+   //
+   // Create and Destroy take effect immediately. Add and Remove only record the change; Commit applies every recorded
+   // change at once, moving each entity at most one time and processing moves grouped by source and destination archetype.
+   class ArchetypeStorage
+   {
+   public:
+      ArchetypeStorage() :
+         m_stagingBlock(0),
+         m_stagingOffset(0)
+      {
+         m_emptyArchetype = GetOrCreateArchetype(0);
+      }
+
+      ArchetypeStorage(const ArchetypeStorage&) = delete;
+      ArchetypeStorage& operator=(const ArchetypeStorage&) = delete;
+
+      ~ArchetypeStorage()
+      {
+         DiscardPending();
+         for (std::byte* block : m_stagingBlocks)
+            Cypher::Memory::Deallocate(block, STAGING_BLOCK_SIZE, Archetype::CHUNK_ALIGNMENT, Cypher::MemoryArena::ECS);
+      }
+
+      void Create(Entity entity)
+      {
+         Entity index = GetEntityIndex(entity);
+         if (index >= m_locations.size())
+            m_locations.resize(static_cast<size_t>(index) + 1);
+
+         // A different generation still occupying the slot is a stale entity that was never destroyed here; drop it
+         EntityLocation& location = m_locations[index];
+         if (location.archetype)
+         {
+            if (location.archetype->GetEntity(location.row) == entity)
+               return;
+            Relocate(location.archetype->Erase(location.row), location.row);
+         }
+
+         location.archetype = m_emptyArchetype;
+         location.row = m_emptyArchetype->Allocate(entity);
+      }
+
+      void Destroy(Entity entity)
+      {
+         if (!Contains(entity))
+            return;
+
+         EntityLocation& location = m_locations[GetEntityIndex(entity)];
+         Relocate(location.archetype->Erase(location.row), location.row);
+         location = EntityLocation();
+      }
+
+      bool Contains(Entity entity) const
+      {
+         Entity index = GetEntityIndex(entity);
+         if (index >= m_locations.size())
+            return false;
+
+         const EntityLocation& location = m_locations[index];
+         return location.archetype && location.archetype->GetEntity(location.row) == entity;
+      }
+
+      template<Component Comp>
+      void Add(Entity entity, Comp component)
+      {
+         const ComponentInfo& info = ComponentRegistry::GetInfo(ComponentRegistry::GetID<Comp>());
+         void* value = Stage(info);
+         new(value) Comp(std::move(component));
+         m_pending.push_back({ entity, info.id, value });
+      }
+
+      template<Component Comp>
+      void Remove(Entity entity) { m_pending.push_back({ entity, ComponentRegistry::GetID<Comp>(), nullptr }); }
+
+      void Commit()
+      {
+         if (m_pending.empty())
+            return;
+
+         // Group pending changes per entity, keeping submission order, and fold them into the entity's final component set
+         std::stable_sort(m_pending.begin(), m_pending.end(), [](const PendingChange& lhs, const PendingChange& rhs) { return lhs.entity < rhs.entity; });
+
+         m_moves.clear();
+         for (size_t first = 0, last = 0; first < m_pending.size(); first = last)
+         {
+            Entity entity = m_pending[first].entity;
+            while (last < m_pending.size() && m_pending[last].entity == entity)
+               ++last;
+
+            if (!Contains(entity))
+               continue;
+
+            ComponentMask mask = m_locations[GetEntityIndex(entity)].archetype->GetMask();
+            for (size_t i = first; i < last; ++i)
+            {
+               ComponentMask bit = ComponentMask(1) << m_pending[i].component;
+               mask = m_pending[i].value ? (mask | bit) : (mask & ~bit);
+            }
+
+            m_moves.push_back({ entity, m_locations[GetEntityIndex(entity)].archetype, mask, first, last });
+         }
+
+         // Resolve each source/destination pair once and append the moved rows to the destination in runs
+         std::sort(m_moves.begin(), m_moves.end(), [](const PendingMove& lhs, const PendingMove& rhs)
+         {
+            return std::less<Archetype*>()(lhs.source, rhs.source) || (lhs.source == rhs.source && lhs.destinationMask < rhs.destinationMask);
+         });
+
+         Archetype* destination = nullptr;
+         for (const PendingMove& move : m_moves)
+         {
+            if (!destination || destination->GetMask() != move.destinationMask)
+               destination = GetOrCreateArchetype(move.destinationMask);
+
+            ApplyMove(move, *destination);
+         }
+
+         DiscardPending();
+      }
+
+      template<Component Comp>
+      bool Has(Entity entity) const
+      {
+         return Contains(entity) && m_locations[GetEntityIndex(entity)].archetype->Has(ComponentRegistry::GetID<Comp>());
+      }
+
+      template<Component Comp>
+      Comp* Get(Entity entity)
+      {
+         if (!Has<Comp>(entity))
+            return nullptr;
+
+         const EntityLocation& location = m_locations[GetEntityIndex(entity)];
+         return static_cast<Comp*>(location.archetype->GetComponent(location.row, ComponentRegistry::GetID<Comp>()));
+      }
+
+      // Invokes func(count, entities, columns...) once per chunk holding all of Comps, with one pointer per requested column.
+      template<Component... Comps, typename Func>
+      void ForEachChunk(Func&& func)
+      {
+         const ComponentMask required = ComponentRegistry::GetMaskOf<Comps...>();
+         for (const auto& archetype : m_archetypes)
+         {
+            if (!archetype->HasAll(required))
+               continue;
+
+            for (size_t chunk = 0, chunkCount = archetype->ChunkCount(); chunk < chunkCount; ++chunk)
+               func(archetype->ChunkSize(chunk), static_cast<const Entity*>(archetype->GetEntities(chunk)), archetype->template GetColumn<Comps>(chunk)...);
+         }
+      }
+
+      // Invokes func(entity, components...) for every entity holding all of Comps.
+      template<Component... Comps, typename Func>
+      void ForEach(Func&& func)
+      {
+         ForEachChunk<Comps...>([&func](size_t count, const Entity* entities, Comps*... columns)
+         {
+            for (size_t i = 0; i < count; ++i)
+               func(entities[i], columns[i]...);
+         });
+      }
+
+      size_t Size() const
+      {
+         size_t size = 0;
+         for (const auto& archetype : m_archetypes)
+            size += archetype->Size();
+         return size;
+      }
+
+      inline size_t ArchetypeCount() const { return m_archetypes.size(); }
+
+   private:
+      static constexpr size_t STAGING_BLOCK_SIZE = Archetype::CHUNK_SIZE;
+
+      struct EntityLocation
+      {
+         Archetype* archetype = nullptr;
+         size_t row = 0;
+      };
+
+      struct PendingChange
+      {
+         Entity entity;
+         ComponentID component;
+         void* value; // Staged component for an add, nullptr for a remove
+      };
+
+      struct PendingMove
+      {
+         Entity entity;
+         Archetype* source;
+         ComponentMask destinationMask;
+         size_t firstChange;
+         size_t lastChange;
+      };
+
+      Archetype* GetOrCreateArchetype(ComponentMask mask)
+      {
+         auto [it, created] = m_archetypeIndex.try_emplace(mask, nullptr);
+         if (created)
+         {
+            m_archetypes.push_back(std::make_unique<Archetype>(mask));
+            it->second = m_archetypes.back().get();
+         }
+         return it->second;
+      }
+
+      inline void Relocate(Entity moved, size_t row)
+      {
+         if (moved != NULL_ENTITY)
+            m_locations[GetEntityIndex(moved)].row = row;
+      }
+
+      void ApplyMove(const PendingMove& move, Archetype& destination)
+      {
+         EntityLocation& location = m_locations[GetEntityIndex(move.entity)];
+         const ComponentMask sourceMask = location.archetype->GetMask();
+
+         if (&destination != location.archetype)
+         {
+            size_t row;
+            Relocate(location.archetype->MoveTo(location.row, destination, row), location.row);
+            location.archetype = &destination;
+            location.row = row;
+         }
+
+         // Only the last staged value of each component applies. Cells that the move left unconstructed are built from
+         // it directly, cells that already existed are assigned.
+         const ComponentMask addedMask = move.destinationMask & ~sourceMask;
+         ComponentMask applied = 0;
+         for (size_t i = move.lastChange; i-- > move.firstChange;)
+         {
+            const PendingChange& change = m_pending[i];
+            ComponentMask bit = ComponentMask(1) << change.component;
+            if (!change.value || (applied & bit) || !(move.destinationMask & bit))
+               continue;
+
+            const ComponentInfo& info = ComponentRegistry::GetInfo(change.component);
+            void* cell = destination.GetComponent(location.row, change.component);
+            if (addedMask & bit)
+               info.moveConstruct(cell, change.value);
+            else
+               info.moveAssign(cell, change.value);
+            applied |= bit;
+         }
+
+         for (ComponentMask bits = addedMask & ~applied; bits; bits &= bits - 1)
+         {
+            ComponentID id = static_cast<ComponentID>(std::countr_zero(bits));
+            ComponentRegistry::GetInfo(id).construct(destination.GetComponent(location.row, id));
+         }
+      }
+
+      void* Stage(const ComponentInfo& info)
+      {
+         Assert(info.size <= STAGING_BLOCK_SIZE && info.alignment <= Archetype::CHUNK_ALIGNMENT);
+
+         size_t offset = (m_stagingOffset + info.alignment - 1) & ~(info.alignment - 1);
+         if (m_stagingBlocks.empty() || offset + info.size > STAGING_BLOCK_SIZE)
+         {
+            if (!m_stagingBlocks.empty())
+               ++m_stagingBlock;
+            if (m_stagingBlock == m_stagingBlocks.size())
+               m_stagingBlocks.push_back(static_cast<std::byte*>(Cypher::Memory::Allocate(STAGING_BLOCK_SIZE, Archetype::CHUNK_ALIGNMENT, Cypher::MemoryArena::ECS)));
+            offset = 0;
+         }
+
+         m_stagingOffset = offset + info.size;
+         return m_stagingBlocks[m_stagingBlock] + offset;
+      }
+
+      // Destroys staged values and rewinds the staging blocks; the blocks themselves are kept for the next batch.
+      void DiscardPending()
+      {
+         for (const PendingChange& change : m_pending)
+         {
+            if (change.value)
+               ComponentRegistry::GetInfo(change.component).destroy(change.value);
+         }
+
+         m_pending.clear();
+         m_stagingBlock = 0;
+         m_stagingOffset = 0;
+      }
+
+      std::vector<std::unique_ptr<Archetype>> m_archetypes;
+      std::unordered_map<ComponentMask, Archetype*> m_archetypeIndex;
+      Archetype* m_emptyArchetype;
+
+      std::vector<EntityLocation> m_locations;
+
+      std::vector<PendingChange> m_pending;
+      std::vector<PendingMove> m_moves;
+      std::vector<std::byte*> m_stagingBlocks;
+      size_t m_stagingBlock;
+      size_t m_stagingOffset;
+   };
+}
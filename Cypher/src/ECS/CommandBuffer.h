@@ -0,0 +1,312 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../Container/PackedArray.h"
+#include "../Core/Memory.h"
+#include "EntityRegistry.h"
+
+namespace Symphony
+{
+   // Records structural changes to PackedArrays and entities so they can be made at a point where no iteration is in flight.
+   //
+   // Create hands out a handle right away, since the registry is safe to use concurrently, so later commands can refer to
+   // it; discarding the buffer releases it again. Destroy, Add and Remove are only recorded. Playback groups the recorded
+   // commands by array and entity, keeps only the net effect of each group, and applies every array's changes in one
+   // ordered pass: one batched removal, then one batched addition. Destroy removes the entity from every array the
+   // buffer has seen, through Track, Add or Remove, before releasing its handle.
+   class CommandBuffer
+   {
+   public:
+      CommandBuffer() :
+         m_stagingBlock(0),
+         m_stagingOffset(0)
+      {}
+
+      CommandBuffer(const CommandBuffer&) = delete;
+      CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+      CommandBuffer(CommandBuffer&& other) noexcept :
+         m_storages(std::move(other.m_storages)),
+         m_commands(std::move(other.m_commands)),
+         m_created(std::move(other.m_created)),
+         m_destroyed(std::move(other.m_destroyed)),
+         m_removals(std::move(other.m_removals)),
+         m_additions(std::move(other.m_additions)),
+         m_additionValues(std::move(other.m_additionValues)),
+         m_stagingBlocks(std::move(other.m_stagingBlocks)),
+         m_stagingBlock(std::exchange(other.m_stagingBlock, 0)),
+         m_stagingOffset(std::exchange(other.m_stagingOffset, 0))
+      {}
+
+      ~CommandBuffer()
+      {
+         Clear();
+         for (std::byte* block : m_stagingBlocks)
+            Cypher::Memory::Deallocate(block, STAGING_BLOCK_SIZE, STAGING_ALIGNMENT, Cypher::MemoryArena::ECS);
+      }
+
+      [[nodiscard]] Entity Create(EntityRegistry& registry)
+      {
+         Entity entity = registry.Create();
+         if (entity != NULL_ENTITY)
+            m_created.push_back({ &registry, entity });
+         return entity;
+      }
+
+      void Destroy(EntityRegistry& registry, Entity entity) { m_destroyed.push_back({ &registry, entity }); }
+
+      // Makes Destroy remove entities from the array even if no Add or Remove targets it.
+      template<typename Key, Component Comp, typename Alloc>
+      void Track(PackedArray<Key, Comp, Alloc>& array) { FindStorage(array); }
+
+      template<typename Key, Component Comp, typename Alloc>
+      void Add(PackedArray<Key, Comp, Alloc>& array, Key entity, Comp component)
+      {
+         uint32_t storage = FindStorage(array);
+         void* value = Stage(sizeof(Comp), alignof(Comp));
+         new(value) Comp(std::move(component));
+         m_commands.push_back({ storage, static_cast<Entity>(entity), value });
+      }
+
+      template<typename Key, Component Comp, typename Alloc>
+      void Remove(PackedArray<Key, Comp, Alloc>& array, Key entity)
+      {
+         m_commands.push_back({ FindStorage(array), static_cast<Entity>(entity), nullptr });
+      }
+
+      void Playback()
+      {
+         // Stable, so the commands of one array and entity stay in recording order and the last one decides the outcome
+         std::stable_sort(m_commands.begin(), m_commands.end(), [](const Command& lhs, const Command& rhs)
+         {
+            return lhs.storage < rhs.storage || (lhs.storage == rhs.storage && lhs.entity < rhs.entity);
+         });
+
+         std::sort(m_destroyed.begin(), m_destroyed.end(), [](const RegistryEntity& lhs, const RegistryEntity& rhs) { return lhs.entity < rhs.entity; });
+         m_destroyed.erase(std::unique(m_destroyed.begin(), m_destroyed.end(), [](const RegistryEntity& lhs, const RegistryEntity& rhs)
+         {
+            return lhs.entity == rhs.entity && lhs.registry == rhs.registry;
+         }), m_destroyed.end());
+
+         size_t first = 0;
+         for (uint32_t storage = 0; storage < m_storages.size(); ++storage)
+         {
+            size_t last = first;
+            while (last < m_commands.size() && m_commands[last].storage == storage)
+               ++last;
+
+            PlaybackStorage(m_storages[storage], first, last);
+            first = last;
+         }
+
+         for (const RegistryEntity& destroyed : m_destroyed)
+            destroyed.registry->Destroy(destroyed.entity);
+
+         m_created.clear();
+         m_destroyed.clear();
+         Clear();
+      }
+
+      // Drops every recorded command without applying it and releases the handles handed out by Create.
+      void Clear()
+      {
+         for (const Command& command : m_commands)
+         {
+            if (command.value)
+               m_storages[command.storage].destroyValue(command.value);
+         }
+
+         for (const RegistryEntity& created : m_created)
+            created.registry->Destroy(created.entity);
+
+         m_commands.clear();
+         m_created.clear();
+         m_destroyed.clear();
+         m_stagingBlock = 0;
+         m_stagingOffset = 0;
+      }
+
+      inline bool Empty() const { return m_commands.empty() && m_destroyed.empty() && m_created.empty(); }
+      inline size_t Size() const { return m_commands.size() + m_destroyed.size(); }
+
+   private:
+      static constexpr size_t STAGING_BLOCK_SIZE = 16 * 1024;
+      static constexpr size_t STAGING_ALIGNMENT = 64;
+
+      // Type-erased operations on one PackedArray.
+      struct Storage
+      {
+         void* array;
+         void (*putRange)(void* array, std::span<const Entity> entities, std::span<void* const> values);
+         void (*removeRange)(void* array, std::span<const Entity> entities);
+         void (*destroyValue)(void* value);
+      };
+
+      struct Command
+      {
+         uint32_t storage;
+         Entity entity;
+         void* value; // Staged component for an add, nullptr for a remove
+      };
+
+      struct RegistryEntity
+      {
+         EntityRegistry* registry;
+         Entity entity;
+      };
+
+      template<typename Key, Component Comp, typename Alloc>
+      uint32_t FindStorage(PackedArray<Key, Comp, Alloc>& array)
+      {
+         using ArrayType = PackedArray<Key, Comp, Alloc>;
+
+         for (uint32_t i = 0; i < m_storages.size(); ++i)
+         {
+            if (m_storages[i].array == &array)
+               return i;
+         }
+
+         m_storages.push_back({
+            &array,
+            [](void* target, std::span<const Entity> entities, std::span<void* const> values)
+            {
+               ArrayType& array = *static_cast<ArrayType*>(target);
+               auto component = [values](size_t i) -> Comp&& { return std::move(*static_cast<Comp*>(values[i])); };
+
+               // Components still present are replaced in place; the rest are appended in one batch
+               for (size_t i = 0; i < entities.size(); ++i)
+               {
+                  if (array.Contains(static_cast<Key>(entities[i])))
+                     array.GetMutable(static_cast<Key>(entities[i])) = component(i);
+               }
+
+               if constexpr (std::is_same_v<Key, Entity>)
+                  array.AddRange(entities, component);
+               else
+               {
+                  for (size_t i = 0; i < entities.size(); ++i)
+                  {
+                     if (!array.Contains(static_cast<Key>(entities[i])))
+                        array.Add(static_cast<Key>(entities[i]), component(i));
+                  }
+               }
+            },
+            [](void* target, std::span<const Entity> entities)
+            {
+               ArrayType& array = *static_cast<ArrayType*>(target);
+               if constexpr (std::is_same_v<Key, Entity>)
+                  array.RemoveRange(entities);
+               else
+               {
+                  for (Entity entity : entities)
+                     array.Remove(static_cast<Key>(entity));
+               }
+            },
+            [](void* value) { static_cast<Comp*>(value)->~Comp(); }
+         });
+         return static_cast<uint32_t>(m_storages.size() - 1);
+      }
+
+      bool IsDestroyed(Entity entity) const
+      {
+         return std::binary_search(m_destroyed.begin(), m_destroyed.end(), RegistryEntity{ nullptr, entity },
+            [](const RegistryEntity& lhs, const RegistryEntity& rhs) { return lhs.entity < rhs.entity; });
+      }
+
+      // Applies the commands in [first, last), all of which target storage and are sorted by entity.
+      void PlaybackStorage(const Storage& storage, size_t first, size_t last)
+      {
+         // Keep only the final command of each entity; a destroyed entity ends up removed whatever was recorded for it
+         size_t netCount = 0;
+         for (size_t i = first; i < last;)
+         {
+            size_t end = i + 1;
+            while (end < last && m_commands[end].entity == m_commands[i].entity)
+               ++end;
+
+            Command net = m_commands[end - 1];
+            if (net.value && IsDestroyed(net.entity))
+               net.value = nullptr;
+
+            for (size_t j = i; j < end; ++j)
+            {
+               if (m_commands[j].value && m_commands[j].value != net.value)
+                  storage.destroyValue(m_commands[j].value);
+               m_commands[j].value = nullptr;
+            }
+
+            m_commands[first + netCount++] = net;
+            i = end;
+         }
+
+         m_removals.clear();
+         m_additions.clear();
+         m_additionValues.clear();
+         for (size_t i = first; i < first + netCount; ++i)
+         {
+            if (!m_commands[i].value)
+               m_removals.push_back(m_commands[i].entity);
+            else
+            {
+               m_additions.push_back(m_commands[i].entity);
+               m_additionValues.push_back(m_commands[i].value);
+            }
+         }
+
+         for (const RegistryEntity& destroyed : m_destroyed)
+            m_removals.push_back(destroyed.entity);
+
+         if (!m_removals.empty())
+            storage.removeRange(storage.array, m_removals);
+
+         if (!m_additions.empty())
+            storage.putRange(storage.array, m_additions, m_additionValues);
+
+         for (size_t i = first; i < first + netCount; ++i)
+         {
+            Command& command = m_commands[i];
+            if (!command.value)
+               continue;
+
+            storage.destroyValue(command.value);
+            command.value = nullptr;
+         }
+      }
+
+      void* Stage(size_t size, size_t alignment)
+      {
+         Assert(size <= STAGING_BLOCK_SIZE && alignment <= STAGING_ALIGNMENT);
+
+         size_t offset = (m_stagingOffset + alignment - 1) & ~(alignment - 1);
+         if (m_stagingBlocks.empty() || offset + size > STAGING_BLOCK_SIZE)
+         {
+            if (!m_stagingBlocks.empty())
+               ++m_stagingBlock;
+            if (m_stagingBlock == m_stagingBlocks.size())
+               m_stagingBlocks.push_back(static_cast<std::byte*>(Cypher::Memory::Allocate(STAGING_BLOCK_SIZE, STAGING_ALIGNMENT, Cypher::MemoryArena::ECS)));
+            offset = 0;
+         }
+
+         m_stagingOffset = offset + size;
+         return m_stagingBlocks[m_stagingBlock] + offset;
+      }
+
+      std::vector<Storage> m_storages;
+      std::vector<Command> m_commands;
+      std::vector<RegistryEntity> m_created;
+      std::vector<RegistryEntity> m_destroyed;
+      std::vector<Entity> m_removals;
+      std::vector<Entity> m_additions;
+      std::vector<void*> m_additionValues;
+      std::vector<std::byte*> m_stagingBlocks;
+      size_t m_stagingBlock;
+      size_t m_stagingOffset;
+   };
+}
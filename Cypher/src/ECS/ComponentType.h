@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Common.h"
+#include "Defines.h"
+
+namespace Symphony
+{
+   using ComponentMask = uint64_t;
+
+   static const constexpr size_t MAX_COMPONENTS = 64;
+
+   // Type-erased lifetime operations for a component type, used by storage that lays out several component types in one allocation.
+   struct ComponentInfo
+   {
+      ComponentID id = NULL_COMPONENT;
+      size_t size = 0;
+      size_t alignment = 0;
+
+      void (*construct)(void* dst) = nullptr;
+      void (*moveConstruct)(void* dst, void* src) = nullptr;
+      void (*moveAssign)(void* dst, void* src) = nullptr;
+      void (*destroy)(void* dst) = nullptr;
+   };
+
+   class ComponentRegistry
+   {
+   public:
+      template<Component Comp>
+      static ComponentID GetID()
+      {
+         static const ComponentID id = Register<std::remove_cvref_t<Comp>>();
+         return id;
+      }
+
+      template<Component Comp>
+      static ComponentMask GetMask() { return ComponentMask(1) << GetID<Comp>(); }
+
+      template<Component... Comps>
+      static ComponentMask GetMaskOf() { return (ComponentMask(0) | ... | GetMask<Comps>()); }
+
+      static const ComponentInfo& GetInfo(ComponentID id)
+      {
+         Assert(id < MAX_COMPONENTS);
+         return GetInstance().m_infos[id];
+      }
+
+      static size_t Count() { return GetInstance().m_count.load(std::memory_order_acquire); }
+
+   private:
+      ComponentRegistry() : m_count(0) {}
+
+      static ComponentRegistry& GetInstance()
+      {
+         static ComponentRegistry registry;
+         return registry;
+      }
+
+      template<typename Comp>
+      static ComponentID Register()
+      {
+         ComponentRegistry& registry = GetInstance();
+         ComponentID id = registry.m_count.fetch_add(1, std::memory_order_acq_rel);
+         if (id >= MAX_COMPONENTS)
+            throw OutOfBoundsException(id, MAX_COMPONENTS - 1);
+
+         ComponentInfo& info = registry.m_infos[id];
+         info.id = id;
+         info.size = sizeof(Comp);
+         info.alignment = alignof(Comp);
+         info.construct = [](void* dst) { new(dst) Comp(); };
+         info.moveConstruct = [](void* dst, void* src) { new(dst) Comp(std::move(*static_cast<Comp*>(src))); };
+         info.moveAssign = [](void* dst, void* src) { *static_cast<Comp*>(dst) = std::move(*static_cast<Comp*>(src)); };
+         info.destroy = [](void* dst) { static_cast<Comp*>(dst)->~Comp(); };
+         return id;
+      }
+
+      std::array<ComponentInfo, MAX_COMPONENTS> m_infos;
+      std::atomic<ComponentID> m_count;
+   };
+}
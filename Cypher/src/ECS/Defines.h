@@ -1,9 +1,10 @@
 #pragma once
 
 #include <concepts>
+#include <memory>
 #include <type_traits>
 
-#include "Logger.h"
+#include "Core/Logger.h"
 #include "Util/Exception.h"
 #include "Util/YCombinator.h"
 
@@ -22,13 +23,26 @@ namespace Symphony
    static const constexpr Entity NULL_ENTITY = ~0U;
    static const constexpr ComponentID NULL_COMPONENT = ~0U;
 
+   // An entity handle packs a recyclable slot index in its low bits and the slot's generation in its high bits.
+   static const constexpr uint32_t ENTITY_INDEX_BITS = 20;
+   static const constexpr uint32_t ENTITY_GENERATION_BITS = 12;
+   static const constexpr Entity ENTITY_INDEX_MASK = (1U << ENTITY_INDEX_BITS) - 1;
+   static const constexpr Entity ENTITY_GENERATION_MASK = (1U << ENTITY_GENERATION_BITS) - 1;
+
+   constexpr Entity MakeEntity(Entity index, Entity generation) { return ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK); }
+   constexpr Entity GetEntityIndex(Entity entity) { return entity & ENTITY_INDEX_MASK; }
+   constexpr Entity GetEntityGeneration(Entity entity) { return (entity >> ENTITY_INDEX_BITS) & ENTITY_GENERATION_MASK; }
+
    template<typename T>
    concept Component = std::is_class_v<T> && std::is_default_constructible_v<T>;
 
+   template <typename Alloc, typename T>
+   using RebindAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
    template <typename Alloc>
    concept Allocator = requires(Alloc a, typename Alloc::value_type * p, size_t n)
    {
-      typename Alloc::template rebind_alloc<int>;
+      typename RebindAlloc<Alloc, int>;
 
       { a.allocate(n) } -> std::same_as<typename Alloc::value_type*>;
       { a.deallocate(p, n) } -> std::same_as<void>;
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "Defines.h"
+
+namespace Symphony
+{
+   // Hands out generational entity handles and recycles the indices of destroyed entities, so that
+   // storage keyed by GetEntityIndex stays as dense as the live entity count. Create, Destroy and
+   // IsValid are lock-free and may be called from any thread.
+   //
+   // Each slot holds the handle last issued for its index and whether that handle is alive. Destroy
+   // marks the slot dead and stores the next generation's handle, which Create issues when it pops the
+   // index. The generation has ENTITY_GENERATION_BITS bits and wraps silently, so a handle kept across
+   // 4096 destroy/create cycles of the same index becomes valid again.
+   class EntityRegistry
+   {
+   public:
+      static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+      static constexpr size_t MAX_CAPACITY = ENTITY_INDEX_MASK; // The last index is reserved by NULL_ENTITY
+
+      explicit EntityRegistry(size_t capacity = DEFAULT_CAPACITY) :
+         m_capacity(std::min(capacity, MAX_CAPACITY)),
+         m_entities(std::make_unique<std::atomic<uint64_t>[]>(m_capacity)),
+         m_nextFree(std::make_unique<std::atomic<Entity>[]>(m_capacity)),
+         m_freeHead(PackFreeHead(0, NULL_INDEX)),
+         m_issued(0),
+         m_alive(0)
+      {
+         for (size_t i = 0; i < m_capacity; ++i)
+            m_entities[i].store(MakeSlot(NULL_ENTITY, false), std::memory_order_relaxed);
+      }
+
+      EntityRegistry(const EntityRegistry&) = delete;
+      EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+      ~EntityRegistry() = default;
+
+      [[nodiscard]] Entity Create()
+      {
+         Entity entity;
+         Entity index = PopFree();
+         if (index != NULL_INDEX)
+         {
+            // A popped index belongs to this thread alone; its slot already holds the next generation's handle
+            entity = GetSlotEntity(m_entities[index].load(std::memory_order_acquire));
+         }
+         else
+         {
+            index = m_issued.load(std::memory_order_relaxed);
+            do
+            {
+               if (index >= m_capacity) [[unlikely]]
+                  return NULL_ENTITY;
+            } while (!m_issued.compare_exchange_weak(index, index + 1, std::memory_order_relaxed));
+
+            entity = MakeEntity(index, 0);
+         }
+
+         m_entities[index].store(MakeSlot(entity, true), std::memory_order_release);
+         m_alive.fetch_add(1, std::memory_order_relaxed);
+         return entity;
+      }
+
+      bool Destroy(Entity entity)
+      {
+         Entity index = GetEntityIndex(entity);
+         if (index >= m_capacity)
+            return false;
+
+         // Marking the slot dead invalidates every outstanding copy of the handle, and a dead slot never
+         // matches, so only the thread that wins the exchange recycles the index, and only once.
+         uint64_t expected = MakeSlot(entity, true);
+         uint64_t recycled = MakeSlot(MakeEntity(index, GetEntityGeneration(entity) + 1), false);
+         if (!m_entities[index].compare_exchange_strong(expected, recycled, std::memory_order_acq_rel))
+            return false;
+
+         PushFree(index);
+         m_alive.fetch_sub(1, std::memory_order_relaxed);
+         return true;
+      }
+
+      [[nodiscard]] inline bool IsValid(Entity entity) const
+      {
+         Entity index = GetEntityIndex(entity);
+         return index < m_capacity && m_entities[index].load(std::memory_order_acquire) == MakeSlot(entity, true);
+      }
+
+      inline size_t Size() const { return m_alive.load(std::memory_order_relaxed); }
+
+      inline size_t Capacity() const { return m_capacity; }
+
+      // Upper bound (exclusive) of every index handed out so far; sparse storage never needs more slots than this.
+      inline size_t IndexExtent() const { return m_issued.load(std::memory_order_relaxed); }
+
+   private:
+      static constexpr Entity NULL_INDEX = ~0U;
+      static constexpr uint64_t ALIVE_BIT = 1ULL << 32;
+
+      // A slot packs the handle in the low 32 bits and the alive flag above it.
+      static constexpr uint64_t MakeSlot(Entity entity, bool alive) { return (alive ? ALIVE_BIT : 0) | entity; }
+      static constexpr Entity GetSlotEntity(uint64_t slot) { return static_cast<Entity>(slot); }
+
+      // The free list head pairs the top index with a tag that changes on every update to defeat ABA.
+      static constexpr uint64_t PackFreeHead(uint32_t tag, Entity index) { return (static_cast<uint64_t>(tag) << 32) | index; }
+      static constexpr uint32_t GetFreeHeadTag(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+      static constexpr Entity GetFreeHeadIndex(uint64_t head) { return static_cast<Entity>(head); }
+
+      void PushFree(Entity index)
+      {
+         uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+         uint64_t newHead;
+         do
+         {
+            m_nextFree[index].store(GetFreeHeadIndex(head), std::memory_order_relaxed);
+            newHead = PackFreeHead(GetFreeHeadTag(head) + 1, index);
+         } while (!m_freeHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+      }
+
+      Entity PopFree()
+      {
+         uint64_t head = m_freeHead.load(std::memory_order_acquire);
+         while (GetFreeHeadIndex(head) != NULL_INDEX)
+         {
+            Entity index = GetFreeHeadIndex(head);
+            uint64_t newHead = PackFreeHead(GetFreeHeadTag(head) + 1, m_nextFree[index].load(std::memory_order_relaxed));
+            if (m_freeHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+               return index;
+         }
+         return NULL_INDEX;
+      }
+
+      const size_t m_capacity;
+      std::unique_ptr<std::atomic<uint64_t>[]> m_entities;
+      std::unique_ptr<std::atomic<Entity>[]> m_nextFree;
+      std::atomic<uint64_t> m_freeHead;
+      std::atomic<Entity> m_issued;
+      std::atomic<size_t> m_alive;
+   };
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <tuple>
+#include <utility>
+
+#include "../Container/PackedArray.h"
+
+namespace Symphony
+{
+   // Owns a set of PackedArrays and keeps the entities that have every owned component at the front of each array, in
+   // the same order. Joint iteration is then a linear walk over [0, Size()) of every dense array with no lookups.
+   //
+   // The group observes its arrays: an entity completing the set is swapped to the end of the shared prefix, and one
+   // about to lose a component is swapped out of it first. An array can be owned by one group at a time.
+   template<typename Entity, Component... Owned>
+   class BasicGroup
+   {
+      static_assert(sizeof...(Owned) > 1, "Group: at least two component types must be owned.");
+
+   public:
+      BasicGroup(PackedArray<Entity, Owned>&... arrays) :
+         m_arrays(&arrays...),
+         m_size(0)
+      {
+         std::apply([this](auto*... arrays)
+         {
+            (arrays->SetObserver({ this, &BasicGroup::OnAdded, &BasicGroup::OnRemoving }), ...);
+         }, m_arrays);
+
+         // Pull in the entities that already have every owned component
+         auto& first = *std::get<0>(m_arrays);
+         for (size_t i = 0; i < first.Size(); ++i)
+            OnAdded(this, first.GetEntityAt(i));
+      }
+
+      BasicGroup(const BasicGroup&) = delete;
+      BasicGroup& operator=(const BasicGroup&) = delete;
+
+      ~BasicGroup()
+      {
+         std::apply([](auto*... arrays) { (arrays->SetObserver({}), ...); }, m_arrays);
+      }
+
+      // Invokes func(entity, components...) for every entity in the group.
+      template<typename Func>
+      void Each(Func&& func)
+      {
+         const Entity* entities = std::get<0>(m_arrays)->Entities();
+         std::tuple<Owned*...> data(std::get<PackedArray<Entity, Owned>*>(m_arrays)->Data()...);
+
+         for (size_t i = 0; i < m_size; ++i)
+            func(entities[i], std::get<Owned*>(data)[i]...);
+      }
+
+      bool Contains(Entity entity) const
+      {
+         size_t index = std::get<0>(m_arrays)->IndexOf(entity);
+         return index < m_size;
+      }
+
+      // The grouped components of Comp's array; entries [0, Size()) line up with Entities().
+      template<Component Comp>
+      Comp* Data() { return std::get<PackedArray<Entity, Comp>*>(m_arrays)->Data(); }
+
+      const Entity* Entities() const { return std::get<0>(m_arrays)->Entities(); }
+
+      inline size_t Size() const { return m_size; }
+
+   private:
+      static void OnAdded(void* context, Entity entity)
+      {
+         BasicGroup& group = *static_cast<BasicGroup*>(context);
+         if (group.Contains(entity))
+            return;
+
+         bool ownsAll = std::apply([entity](auto*... arrays) { return (arrays->Contains(entity) && ...); }, group.m_arrays);
+         if (!ownsAll)
+            return;
+
+         std::apply([&group, entity](auto*... arrays) { (arrays->SwapAt(arrays->IndexOf(entity), group.m_size), ...); }, group.m_arrays);
+         ++group.m_size;
+      }
+
+      static void OnRemoving(void* context, Entity entity)
+      {
+         BasicGroup& group = *static_cast<BasicGroup*>(context);
+         if (!group.Contains(entity))
+            return;
+
+         --group.m_size;
+         std::apply([&group, entity](auto*... arrays) { (arrays->SwapAt(arrays->IndexOf(entity), group.m_size), ...); }, group.m_arrays);
+      }
+
+      std::tuple<PackedArray<Entity, Owned>*...> m_arrays;
+      size_t m_size;
+   };
+
+   template<Component... Owned>
+   using Group = BasicGroup<Entity, Owned...>;
+}
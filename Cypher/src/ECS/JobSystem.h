@@ -0,0 +1,300 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "Common.h"
+
+namespace Symphony
+{
+   // Number of jobs still outstanding for one batch of work. Each job tied to the counter decrements it when finished;
+   // a counter at zero acts as a fence that JobSystem::Wait can block on.
+   class JobCounter
+   {
+   public:
+      JobCounter() : m_pending(0) {}
+
+      JobCounter(const JobCounter&) = delete;
+      JobCounter& operator=(const JobCounter&) = delete;
+
+      inline void Add(int64_t count) { m_pending.fetch_add(count, std::memory_order_relaxed); }
+      inline void Done() { m_pending.fetch_sub(1, std::memory_order_release); }
+      inline bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+   private:
+      std::atomic<int64_t> m_pending;
+   };
+
+   // A unit of work. The storage belongs to whoever schedules it and must stay alive until the job has run.
+   struct Job
+   {
+      void (*function)(void* context) = nullptr;
+      void* context = nullptr;
+      JobCounter* counter = nullptr;
+   };
+
+   // Bounded Chase-Lev deque. The owning thread pushes and pops at the bottom without contention; other threads steal
+   // from the top, and only a race for the last job costs a compare-and-swap.
+   class WorkStealingDeque
+   {
+   public:
+      static constexpr int64_t CAPACITY = 4096;
+
+      WorkStealingDeque() : m_top(0), m_bottom(0)
+      {
+         for (std::atomic<Job*>& slot : m_slots)
+            slot.store(nullptr, std::memory_order_relaxed);
+      }
+
+      // Owner only. Returns false if the deque is full.
+      bool Push(Job* job)
+      {
+         int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+         int64_t top = m_top.load(std::memory_order_acquire);
+         if (bottom - top >= CAPACITY)
+            return false;
+
+         m_slots[bottom & MASK].store(job, std::memory_order_relaxed);
+         m_bottom.store(bottom + 1, std::memory_order_release);
+         return true;
+      }
+
+      // Owner only. Takes the most recently pushed job.
+      Job* Pop()
+      {
+         int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+         m_bottom.store(bottom, std::memory_order_seq_cst);
+         int64_t top = m_top.load(std::memory_order_seq_cst);
+
+         if (top > bottom)
+         {
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+         }
+
+         Job* job = m_slots[bottom & MASK].load(std::memory_order_relaxed);
+         if (top == bottom)
+         {
+            // Last job: race any thief for it
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+               job = nullptr;
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+         }
+         return job;
+      }
+
+      // Any thread. Takes the oldest job, or nothing if the deque is empty or another thread won the race.
+      Job* Steal()
+      {
+         int64_t top = m_top.load(std::memory_order_seq_cst);
+         int64_t bottom = m_bottom.load(std::memory_order_seq_cst);
+         if (top >= bottom)
+            return nullptr;
+
+         Job* job = m_slots[top & MASK].load(std::memory_order_relaxed);
+         if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+         return job;
+      }
+
+      inline bool IsEmpty() const { return m_top.load(std::memory_order_relaxed) >= m_bottom.load(std::memory_order_relaxed); }
+
+   private:
+      static constexpr int64_t MASK = CAPACITY - 1;
+
+      std::array<std::atomic<Job*>, CAPACITY> m_slots;
+      alignas(64) std::atomic<int64_t> m_top;
+      alignas(64) std::atomic<int64_t> m_bottom;
+   };
+
+   // Fixed pool of workers running fire-and-forget jobs. Each worker owns a work-stealing deque: jobs scheduled from a
+   // worker go to its own deque and are run newest first, idle workers steal the oldest jobs of others, and jobs
+   // scheduled from any other thread go through a shared queue. Threads that Wait on a counter run jobs meanwhile, so a
+   // job may schedule and wait on further jobs without tying up a worker.
+   class JobSystem
+   {
+   public:
+      explicit JobSystem(size_t threadCount = DefaultThreadCount()) :
+         m_deques(std::make_unique<WorkStealingDeque[]>(threadCount)),
+         m_queued(0),
+         m_sleeping(0),
+         m_stopping(false)
+      {
+         m_threads.reserve(threadCount);
+         for (size_t i = 0; i < threadCount; ++i)
+            m_threads.emplace_back(&JobSystem::WorkerMain, this, i);
+      }
+
+      JobSystem(const JobSystem&) = delete;
+      JobSystem& operator=(const JobSystem&) = delete;
+
+      ~JobSystem()
+      {
+         {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stopping = true;
+         }
+         m_wake.notify_all();
+
+         for (std::thread& thread : m_threads)
+            thread.join();
+      }
+
+      static JobSystem& GetDefault()
+      {
+         static JobSystem system;
+         return system;
+      }
+
+      static size_t DefaultThreadCount()
+      {
+         unsigned int hardware = std::thread::hardware_concurrency();
+         return hardware > 1 ? hardware - 1 : 1;
+      }
+
+      inline size_t WorkerCount() const { return m_threads.size(); }
+
+      // Queues a job; its counter, if any, must already account for it.
+      void Schedule(Job& job)
+      {
+         Worker& self = GetWorker();
+         if (self.system != this || !m_deques[self.index].Push(&job))
+         {
+            std::lock_guard<std::mutex> lock(m_injectLock);
+            m_injected.push_back(&job);
+         }
+
+         m_queued.fetch_add(1, std::memory_order_seq_cst);
+         if (m_sleeping.load(std::memory_order_seq_cst) > 0)
+         {
+            // Taking the lock orders this notify after any sleeper's check of m_queued, so none can miss it
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_wake.notify_one();
+         }
+      }
+
+      void Schedule(std::span<Job> jobs, JobCounter& counter)
+      {
+         counter.Add(static_cast<int64_t>(jobs.size()));
+         for (Job& job : jobs)
+         {
+            job.counter = &counter;
+            Schedule(job);
+         }
+      }
+
+      // Runs other jobs until the counter reaches zero.
+      void Wait(const JobCounter& counter)
+      {
+         while (!counter.IsDone())
+         {
+            if (!RunOne())
+               std::this_thread::yield();
+         }
+      }
+
+      // Runs a single pending job on the calling thread, if there is one.
+      bool RunOne()
+      {
+         Job* job = Acquire();
+         if (!job)
+            return false;
+
+         Execute(*job);
+         return true;
+      }
+
+   private:
+      struct Worker
+      {
+         JobSystem* system = nullptr;
+         size_t index = 0;
+      };
+
+      static Worker& GetWorker()
+      {
+         thread_local Worker worker;
+         return worker;
+      }
+
+      void WorkerMain(size_t index)
+      {
+         GetWorker() = { this, index };
+
+         for (;;)
+         {
+            if (RunOne())
+               continue;
+
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            m_wake.wait(lock, [this]() { return m_stopping || m_queued.load(std::memory_order_seq_cst) > 0; });
+            m_sleeping.fetch_sub(1, std::memory_order_acq_rel);
+            if (m_stopping)
+               return;
+         }
+      }
+
+      Job* Acquire()
+      {
+         if (m_queued.load(std::memory_order_acquire) == 0)
+            return nullptr;
+
+         Worker& self = GetWorker();
+         const bool isWorker = self.system == this;
+
+         Job* job = isWorker ? m_deques[self.index].Pop() : nullptr;
+         if (!job)
+            job = TakeInjected();
+
+         // Start stealing from the next worker along so thieves spread out instead of all hitting worker 0
+         const size_t workerCount = WorkerCount();
+         const size_t start = isWorker ? self.index + 1 : 0;
+         for (size_t offset = 0; !job && offset < workerCount; ++offset)
+            job = m_deques[(start + offset) % workerCount].Steal();
+
+         if (job)
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+         return job;
+      }
+
+      Job* TakeInjected()
+      {
+         std::lock_guard<std::mutex> lock(m_injectLock);
+         if (m_injected.empty())
+            return nullptr;
+
+         Job* job = m_injected.front();
+         m_injected.pop_front();
+         return job;
+      }
+
+      static void Execute(Job& job)
+      {
+         // Read the counter first: finishing the job may let its owner reuse the storage
+         JobCounter* counter = job.counter;
+         job.function(job.context);
+         if (counter)
+            counter->Done();
+      }
+
+      std::vector<std::thread> m_threads;
+      std::unique_ptr<WorkStealingDeque[]> m_deques;
+
+      std::mutex m_injectLock;
+      std::deque<Job*> m_injected;
+
+      std::mutex m_lock;
+      std::condition_variable m_wake;
+      std::atomic<size_t> m_queued;
+      std::atomic<size_t> m_sleeping;
+      bool m_stopping;
+   };
+}
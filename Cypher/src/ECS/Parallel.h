@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "../Container/PackedArray.h"
+#include "CommandBuffer.h"
+#include "JobSystem.h"
+
+namespace Symphony
+{
+   // Below this many components the loop runs on the calling thread; scheduling jobs costs more than it saves.
+   static const constexpr size_t PARALLEL_THRESHOLD = 4096;
+
+   // Smallest number of components in one job.
+   static const constexpr size_t PARALLEL_MIN_CHUNK = 1024;
+
+   static const constexpr size_t CACHE_LINE_SIZE = 64;
+
+   // Number of components in a chunk of the dense range: a whole number of cache lines long, and a few chunks per
+   // thread to leave room for stealing.
+   template<typename Comp>
+   constexpr size_t ParallelChunkSize(size_t size, size_t threadCount)
+   {
+      constexpr size_t lineMultiple = CACHE_LINE_SIZE / std::gcd(sizeof(Comp), CACHE_LINE_SIZE);
+
+      size_t chunk = std::max(PARALLEL_MIN_CHUNK, size / (threadCount * 4));
+      return (chunk + lineMultiple - 1) / lineMultiple * lineMultiple;
+   }
+
+   // Index of the first component that starts on a cache line. The dense storage is only as aligned as its allocator
+   // makes it, so chunk boundaries are laid out from here rather than from index 0; two workers then never write to
+   // the same line. Returns 0 if no component starts on a line, which only happens when the storage is aligned to less
+   // than gcd(sizeof(Comp), CACHE_LINE_SIZE) bytes; neighbouring chunks may then share a line.
+   template<typename Comp>
+   size_t ParallelChunkOrigin(const Comp* data)
+   {
+      constexpr size_t lineMultiple = CACHE_LINE_SIZE / std::gcd(sizeof(Comp), CACHE_LINE_SIZE);
+
+      const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+      for (size_t i = 0; i < lineMultiple; ++i)
+      {
+         if ((address + i * sizeof(Comp)) % CACHE_LINE_SIZE == 0)
+            return i;
+      }
+      return 0;
+   }
+
+   // Invokes func(entity, component) for every component in the array, split into jobs on the job system; the calling
+   // thread runs jobs too while it waits, so this may be called from inside a job or a TaskGraph system. If func also
+   // accepts a CommandBuffer&, each chunk records structural changes into its own buffer; the buffers are played back
+   // in chunk order on the calling thread once every chunk has run, so the array is never modified while it is being
+   // iterated.
+   template<typename Entity, Component Comp, typename Alloc, typename Func>
+   void ParallelForEach(PackedArray<Entity, Comp, Alloc>& array, Func&& func, JobSystem& jobSystem = JobSystem::GetDefault())
+   {
+      constexpr bool deferred = std::invocable<Func&, Entity, Comp&, CommandBuffer&>;
+      static_assert(deferred || std::invocable<Func&, Entity, Comp&>, "ParallelForEach: func must accept (Entity, Comp&) or (Entity, Comp&, CommandBuffer&).");
+
+      const size_t size = array.Size();
+      const Entity* entities = array.Entities();
+      Comp* components = array.Data();
+
+      std::vector<CommandBuffer> buffers;
+      auto run = [&](size_t begin, size_t end, size_t chunk)
+      {
+         for (size_t i = begin; i < end; ++i)
+         {
+            if constexpr (deferred)
+               func(entities[i], components[i], buffers[chunk]);
+            else
+               func(entities[i], components[i]);
+         }
+      };
+
+      if (size < PARALLEL_THRESHOLD)
+      {
+         if constexpr (deferred)
+            buffers.resize(1);
+         run(0, size, 0);
+      }
+      else
+      {
+         // The calling thread counts as one more worker, as it runs chunks while it waits
+         const size_t chunkSize = ParallelChunkSize<Comp>(size, jobSystem.WorkerCount() + 1);
+         const size_t origin = ParallelChunkOrigin(components);
+         const size_t chunkCount = (size - origin + chunkSize - 1) / chunkSize;
+         if constexpr (deferred)
+            buffers.resize(chunkCount);
+
+         using Run = decltype(run);
+         struct Chunk
+         {
+            Run* run;
+            size_t index;
+            size_t begin;
+            size_t end;
+         };
+
+         std::vector<Chunk> chunks(chunkCount);
+         std::vector<Job> jobs(chunkCount);
+         for (size_t i = 0; i < chunkCount; ++i)
+         {
+            // The first chunk also takes the components ahead of the origin
+            chunks[i] = { &run, i, i == 0 ? 0 : origin + i * chunkSize, std::min(size, origin + (i + 1) * chunkSize) };
+            jobs[i].function = [](void* context)
+            {
+               Chunk& chunk = *static_cast<Chunk*>(context);
+               (*chunk.run)(chunk.begin, chunk.end, chunk.index);
+            };
+            jobs[i].context = &chunks[i];
+         }
+
+         JobCounter counter;
+         jobSystem.Schedule(jobs, counter);
+         jobSystem.Wait(counter);
+      }
+
+      for (CommandBuffer& buffer : buffers)
+         buffer.Playback();
+   }
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ComponentType.h"
+#include "JobSystem.h"
+
+namespace Symphony
+{
+   // Component sets a system reads and writes, for TaskGraph::AddSystem<Read<...>, Write<...>>.
+   template<typename... Comps>
+   struct Read {};
+
+   template<typename... Comps>
+   struct Write {};
+
+   // Access mask of every component, for systems that make structural changes or touch the registry as a whole.
+   static const constexpr ComponentMask ALL_COMPONENTS = ~ComponentMask(0);
+
+   // Per-frame schedule of systems. Each system declares the components it reads and writes; two systems conflict if
+   // either writes something the other touches, and conflicting systems run in the order they were added. Everything
+   // else is free to run at the same time, so Run spreads the systems over the job system without any hand-written
+   // ordering. The graph is rebuilt lazily after systems are added and costs no allocations per frame.
+   class TaskGraph
+   {
+   public:
+      using SystemID = size_t;
+
+      TaskGraph() : m_jobSystem(nullptr), m_built(true) {}
+
+      TaskGraph(const TaskGraph&) = delete;
+      TaskGraph& operator=(const TaskGraph&) = delete;
+
+      SystemID AddSystem(std::string name, ComponentMask reads, ComponentMask writes, std::function<void()> function)
+      {
+         std::unique_ptr<System> system = std::make_unique<System>();
+         system->name = std::move(name);
+         system->reads = reads;
+         system->writes = writes;
+         system->function = std::move(function);
+         system->graph = this;
+         system->job.function = &TaskGraph::RunSystem;
+         system->job.context = system.get();
+         system->job.counter = &m_counter;
+
+         m_systems.push_back(std::move(system));
+         m_built = false;
+         return m_systems.size() - 1;
+      }
+
+      template<typename ReadSet, typename WriteSet = Write<>, typename Func>
+      SystemID AddSystem(std::string name, Func&& function)
+      {
+         return AddSystem(std::move(name), AccessMask<ReadSet>::Get(), AccessMask<WriteSet>::Get(), std::function<void()>(std::forward<Func>(function)));
+      }
+
+      // Orders two systems whose conflict the component sets cannot see, such as shared state outside the registry.
+      void AddDependency(SystemID before, SystemID after)
+      {
+         // Dependencies must follow insertion order, which keeps the graph acyclic
+         Assert(before < after && after < m_systems.size());
+         m_systems[after]->explicitDependencies.push_back(before);
+         m_built = false;
+      }
+
+      // Runs every system once and returns when all have finished; the calling thread helps out meanwhile.
+      void Run(JobSystem& jobSystem = JobSystem::GetDefault())
+      {
+         if (m_systems.empty())
+            return;
+         if (!m_built)
+            Build();
+
+         m_jobSystem = &jobSystem;
+         for (std::unique_ptr<System>& system : m_systems)
+            system->pending.store(system->dependencyCount, std::memory_order_relaxed);
+
+         m_counter.Add(static_cast<int64_t>(m_systems.size()));
+         for (System* root : m_roots)
+            jobSystem.Schedule(root->job);
+
+         jobSystem.Wait(m_counter);
+         m_jobSystem = nullptr;
+      }
+
+      inline size_t GetSystemCount() const { return m_systems.size(); }
+      inline const std::string& GetSystemName(SystemID id) const { return m_systems[id]->name; }
+
+      // Systems that must finish before the given one starts.
+      std::vector<SystemID> GetDependencies(SystemID id)
+      {
+         if (!m_built)
+            Build();
+
+         std::vector<SystemID> dependencies;
+         for (SystemID i = 0; i < id; ++i)
+         {
+            const std::vector<System*>& successors = m_systems[i]->successors;
+            if (std::find(successors.begin(), successors.end(), m_systems[id].get()) != successors.end())
+               dependencies.push_back(i);
+         }
+         return dependencies;
+      }
+
+   private:
+      template<typename Set>
+      struct AccessMask;
+
+      template<typename... Comps>
+      struct AccessMask<Read<Comps...>> { static ComponentMask Get() { return ComponentRegistry::GetMaskOf<Comps...>(); } };
+
+      template<typename... Comps>
+      struct AccessMask<Write<Comps...>> { static ComponentMask Get() { return ComponentRegistry::GetMaskOf<Comps...>(); } };
+
+      struct System
+      {
+         std::string name;
+         ComponentMask reads = 0;
+         ComponentMask writes = 0;
+         std::function<void()> function;
+
+         std::vector<SystemID> explicitDependencies;
+         std::vector<System*> successors;
+         uint32_t dependencyCount = 0;
+         std::atomic<uint32_t> pending = 0;
+
+         TaskGraph* graph = nullptr;
+         Job job;
+      };
+
+      static inline bool Conflicts(const System& a, const System& b)
+      {
+         return (a.writes & (b.reads | b.writes)) || (b.writes & a.reads);
+      }
+
+      void Build()
+      {
+         for (std::unique_ptr<System>& system : m_systems)
+         {
+            system->successors.clear();
+            system->dependencyCount = 0;
+         }
+
+         for (SystemID later = 0; later < m_systems.size(); ++later)
+         {
+            System& system = *m_systems[later];
+            for (SystemID earlier = 0; earlier < later; ++earlier)
+            {
+               System& other = *m_systems[earlier];
+               bool explicitlyOrdered = std::find(system.explicitDependencies.begin(), system.explicitDependencies.end(), earlier) != system.explicitDependencies.end();
+               if (explicitlyOrdered || Conflicts(system, other))
+               {
+                  other.successors.push_back(&system);
+                  ++system.dependencyCount;
+               }
+            }
+         }
+
+         m_roots.clear();
+         for (std::unique_ptr<System>& system : m_systems)
+         {
+            if (system->dependencyCount == 0)
+               m_roots.push_back(system.get());
+         }
+
+         m_built = true;
+      }
+
+      static void RunSystem(void* context)
+      {
+         System& system = *static_cast<System*>(context);
+         system.function();
+
+         // Successors are released before this job counts as done, so the graph counter cannot reach zero early
+         TaskGraph& graph = *system.graph;
+         for (System* successor : system.successors)
+         {
+            if (successor->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+               graph.m_jobSystem->Schedule(successor->job);
+         }
+      }
+
+      std::vector<std::unique_ptr<System>> m_systems;
+      std::vector<System*> m_roots;
+      JobCounter m_counter;
+      JobSystem* m_jobSystem;
+      bool m_built;
+   };
+}
@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "../Container/PackedArray.h"
+
+namespace Symphony
+{
+   template<Component... Comps>
+   struct Include {};
+
+   template<Component... Comps>
+   struct Exclude {};
+
+   // Change filters restrict a view to the chunks of one included array that were written (Changed) or had components
+   // added (Added) after the version passed to Since. The filtered array becomes the pivot, and matching is done at chunk
+   // granularity, so unchanged neighbours of a changed component are visited too.
+   struct Unfiltered {};
+
+   template<Component Comp>
+   struct Changed {};
+
+   template<Component Comp>
+   struct Added {};
+
+   template<typename Filter>
+   struct ChangeFilterTraits
+   {
+      static constexpr bool ENABLED = false;
+      static constexpr bool ADDED = false;
+      using Type = void;
+   };
+
+   template<Component Comp>
+   struct ChangeFilterTraits<Changed<Comp>>
+   {
+      static constexpr bool ENABLED = true;
+      static constexpr bool ADDED = false;
+      using Type = Comp;
+   };
+
+   template<Component Comp>
+   struct ChangeFilterTraits<Added<Comp>>
+   {
+      static constexpr bool ENABLED = true;
+      static constexpr bool ADDED = true;
+      using Type = Comp;
+   };
+
+   template<typename Entity, typename Included, typename Excluded = Exclude<>, typename Filter = Unfiltered>
+   class BasicView;
+
+   // Iterates every entity present in all included PackedArrays and absent from all excluded ones. The smallest included
+   // array is picked as the pivot when iteration starts; its entities are tested against the other arrays a batch at a
+   // time, so each array's sparse pages are probed in one tight loop instead of interleaved per entity.
+   template<typename Entity, Component... Comps, Component... Excluded, typename Filter>
+   class BasicView<Entity, Include<Comps...>, Exclude<Excluded...>, Filter>
+   {
+      static_assert(sizeof...(Comps) > 0, "View: at least one component type must be included.");
+
+      using FilterTraits = ChangeFilterTraits<Filter>;
+
+      static constexpr size_t FilteredIndex()
+      {
+         constexpr bool matches[] = { std::is_same_v<typename FilterTraits::Type, Comps>... };
+         for (size_t i = 0; i < sizeof...(Comps); ++i)
+         {
+            if (matches[i])
+               return i;
+         }
+         return sizeof...(Comps);
+      }
+
+      static constexpr size_t FILTERED_INDEX = FilteredIndex();
+      static_assert(!FilterTraits::ENABLED || FILTERED_INDEX < sizeof...(Comps), "View: a change filter must name an included component type.");
+
+   public:
+      static constexpr size_t BATCH_SIZE = 64;
+      static_assert(((BATCH_SIZE == PackedArray<Entity, Comps>::CHANGE_CHUNK_SIZE) && ...), "View: batches must line up with change tracking chunks.");
+
+   private:
+      using BatchMask = uint64_t;
+      using BatchIndices = std::array<std::array<size_t, BATCH_SIZE>, sizeof...(Comps)>;
+
+   public:
+
+      using value_type = std::tuple<Entity, Comps&...>;
+
+      class Iterator
+      {
+      public:
+         using iterator_category = std::forward_iterator_tag;
+         using value_type = BasicView::value_type;
+         using difference_type = std::ptrdiff_t;
+         using pointer = void;
+         using reference = value_type;
+
+         bool operator==(const Iterator& rhs) const { return m_batchStart == rhs.m_batchStart && m_mask == rhs.m_mask; }
+         bool operator!=(const Iterator& rhs) const { return !(*this == rhs); }
+
+         value_type operator*() const
+         {
+            Entity entity = m_pivot[m_batchStart + std::countr_zero(m_mask)];
+            return m_view->Fetch(entity, std::index_sequence_for<Comps...>());
+         }
+
+         Iterator& operator++()
+         {
+            m_mask &= m_mask - 1;
+            if (!m_mask)
+               NextBatch(m_batchStart + BATCH_SIZE);
+            return *this;
+         }
+
+         Iterator operator++(int)
+         {
+            Iterator tmp(*this);
+            ++(*this);
+            return tmp;
+         }
+
+      private:
+         Iterator(BasicView* view, const Entity* pivot, size_t pivotSize, size_t batchStart) :
+            m_view(view),
+            m_pivot(pivot),
+            m_pivotSize(pivotSize),
+            m_batchStart(pivotSize),
+            m_mask(0)
+         {
+            NextBatch(batchStart);
+         }
+
+         void NextBatch(size_t batchStart)
+         {
+            for (m_batchStart = batchStart; m_batchStart < m_pivotSize; m_batchStart += BATCH_SIZE)
+            {
+               if (!m_view->PassesChangeFilter(m_batchStart))
+                  continue;
+
+               m_mask = m_view->template FilterBatch<false>(m_pivot + m_batchStart, std::min(BATCH_SIZE, m_pivotSize - m_batchStart), m_batchStart, nullptr);
+               if (m_mask)
+                  return;
+            }
+            m_batchStart = m_pivotSize;
+            m_mask = 0;
+         }
+
+         friend class BasicView;
+
+         BasicView* m_view;
+         const Entity* m_pivot;
+         size_t m_pivotSize;
+         size_t m_batchStart;
+         BatchMask m_mask;
+      };
+
+      BasicView(PackedArray<Entity, Comps>&... included, PackedArray<Entity, Excluded>&... excluded) :
+         m_included(&included...),
+         m_excluded(&excluded...),
+         m_pivot(0),
+         m_since(0)
+      {}
+
+      // Version a change filter compares against, usually the one returned by AdvanceVersion when the reader last ran.
+      BasicView& Since(uint32_t version)
+      {
+         m_since = version;
+         return *this;
+      }
+
+      // Invokes func(entity, components...) for every matching entity.
+      template<typename Func>
+      void Each(Func&& func)
+      {
+         SelectPivot();
+         const Entity* entities = PivotEntities();
+         const size_t size = PivotSize();
+
+         BatchIndices indices;
+         for (size_t start = 0; start < size; start += BATCH_SIZE)
+         {
+            if (!PassesChangeFilter(start))
+               continue;
+
+            BatchMask mask = FilterBatch<true>(entities + start, std::min(BATCH_SIZE, size - start), start, &indices);
+            for (; mask; mask &= mask - 1)
+            {
+               size_t slot = std::countr_zero(mask);
+               Invoke(func, entities[start + slot], slot, indices, std::index_sequence_for<Comps...>());
+            }
+         }
+      }
+
+      Iterator begin()
+      {
+         SelectPivot();
+         return Iterator(this, PivotEntities(), PivotSize(), 0);
+      }
+
+      Iterator end()
+      {
+         size_t size = PivotSize();
+         return Iterator(this, PivotEntities(), size, size);
+      }
+
+      // Upper bound on the number of matches: the size of the smallest included array.
+      size_t SizeHint() const
+      {
+         size_t size = std::numeric_limits<size_t>::max();
+         std::apply([&size](auto*... arrays) { ((size = std::min(size, arrays->Size())), ...); }, m_included);
+         return size;
+      }
+
+   private:
+      void SelectPivot()
+      {
+         if constexpr (FilterTraits::ENABLED)
+         {
+            m_pivot = FILTERED_INDEX;
+            return;
+         }
+
+         size_t smallest = std::numeric_limits<size_t>::max();
+         size_t index = 0;
+         std::apply([&](auto*... arrays)
+         {
+            ((arrays->Size() < smallest ? (smallest = arrays->Size(), m_pivot = index++) : index++), ...);
+         }, m_included);
+      }
+
+      bool PassesChangeFilter(size_t batchStart) const
+      {
+         if constexpr (FilterTraits::ENABLED)
+         {
+            const auto& array = *std::get<FILTERED_INDEX>(m_included);
+            size_t chunk = batchStart / BATCH_SIZE;
+            return FilterTraits::ADDED ? array.AddedSince(chunk, m_since) : array.ChangedSince(chunk, m_since);
+         }
+         else
+            return true;
+      }
+
+      const Entity* PivotEntities() const { return VisitPivot([](const auto* array) { return array->Entities(); }); }
+      size_t PivotSize() const { return VisitPivot([](const auto* array) { return array->Size(); }); }
+
+      template<typename Func>
+      decltype(auto) VisitPivot(Func&& func) const { return VisitPivot(func, std::index_sequence_for<Comps...>()); }
+
+      template<typename Func, size_t... I>
+      decltype(auto) VisitPivot(Func& func, std::index_sequence<I...>) const
+      {
+         using Result = decltype(func(std::get<0>(m_included)));
+         Result result{};
+         ((I == m_pivot ? (result = func(std::get<I>(m_included)), true) : false) || ...);
+         return result;
+      }
+
+      // Returns a mask of the entities in the batch that match every filter. When StoreIndices is set, the dense index of
+      // each entity in every included array is written to indices so the caller need not look it up again.
+      template<bool StoreIndices>
+      BatchMask FilterBatch(const Entity* entities, size_t count, size_t batchStart, BatchIndices* indices) const
+      {
+         BatchMask mask = count == BATCH_SIZE ? ~BatchMask(0) : (BatchMask(1) << count) - 1;
+
+         [&]<size_t... I>(std::index_sequence<I...>)
+         {
+            (FilterIncluded<StoreIndices, I>(entities, count, batchStart, indices, mask), ...);
+         }(std::index_sequence_for<Comps...>());
+
+         std::apply([&](auto*... arrays)
+         {
+            (FilterExcluded(*arrays, entities, count, mask), ...);
+         }, m_excluded);
+
+         return mask;
+      }
+
+      template<bool StoreIndices, size_t I>
+      void FilterIncluded(const Entity* entities, size_t count, size_t batchStart, BatchIndices* indices, BatchMask& mask) const
+      {
+         if (I == m_pivot)
+         {
+            if constexpr (StoreIndices)
+            {
+               for (size_t slot = 0; slot < count; ++slot)
+                  (*indices)[I][slot] = batchStart + slot;
+            }
+            return;
+         }
+
+         const auto& array = *std::get<I>(m_included);
+         for (size_t slot = 0; slot < count; ++slot)
+         {
+            size_t index = array.IndexOf(entities[slot]);
+            if constexpr (StoreIndices)
+               (*indices)[I][slot] = index;
+            mask &= ~(BatchMask(index == std::remove_reference_t<decltype(array)>::INVALID_INDEX) << slot);
+         }
+      }
+
+      template<typename Array>
+      static void FilterExcluded(const Array& array, const Entity* entities, size_t count, BatchMask& mask)
+      {
+         for (size_t slot = 0; slot < count; ++slot)
+            mask &= ~(BatchMask(array.Contains(entities[slot])) << slot);
+      }
+
+      template<typename Func, size_t... I>
+      void Invoke(Func& func, Entity entity, size_t slot, const BatchIndices& indices, std::index_sequence<I...>)
+      {
+         func(entity, std::get<I>(m_included)->GetAt(indices[I][slot])...);
+      }
+
+      template<size_t... I>
+      value_type Fetch(Entity entity, std::index_sequence<I...>)
+      {
+         return value_type(entity, std::get<I>(m_included)->GetAt(std::get<I>(m_included)->IndexOf(entity))...);
+      }
+
+      std::tuple<PackedArray<Entity, Comps>*...> m_included;
+      std::tuple<PackedArray<Entity, Excluded>*...> m_excluded;
+      size_t m_pivot;
+      uint32_t m_since;
+   };
+
+   template<Component... Comps>
+   using View = BasicView<Entity, Include<Comps...>>;
+
+   template<typename Included, typename Excluded, typename Filter = Unfiltered>
+   using FilteredView = BasicView<Entity, Included, Excluded, Filter>;
+}
@@ -19,9 +19,9 @@ namespace Cypher
    template<typename T>
    class Matrix2x2 : public GLMType<glm::mat<2, 2, T>>
    {
-      Matrix2x2<T>() : m_glmMatrix(static_cast<T>(1)) {}
-      Matrix2x2<T>(T a, T b, T c, T d) : m_glmMatrix(a, b, c, d) {}
-      Matrix2x2<T>(const glm::mat<2, 2, T>& mat) : m_glmMatrix(mat) {}
+      Matrix2x2() : m_glmMatrix(static_cast<T>(1)) {}
+      Matrix2x2(T a, T b, T c, T d) : m_glmMatrix(a, b, c, d) {}
+      Matrix2x2(const glm::mat<2, 2, T>& mat) : m_glmMatrix(mat) {}
 
       Matrix2x2<T> operator+(const Matrix2x2<T>& rhs) const { return Matrix2x2<T>(m_glmMatrix + rhs.m_glmMatrix); }
       Matrix2x2<T> operator-(const Matrix2x2<T>& rhs) const { return Matrix2x2<T>(m_glmMatrix - rhs.m_glmMatrix); }
@@ -61,9 +61,9 @@ namespace Cypher
    template<typename T>
    class Matrix2x3 : public GLMType<glm::mat<2, 3, T>>
    {
-      Matrix2x3<T>() : m_glmMatrix(static_cast<T>(1)) {}
-      Matrix2x3<T>(T a, T b, T c, T d, T e, T f) : m_glmMatrix(a, b, c, d, e, f) {}
-      Matrix2x3<T>(const glm::mat<2, 3, T>& mat) : m_glmMatrix(mat) {}
+      Matrix2x3() : m_glmMatrix(static_cast<T>(1)) {}
+      Matrix2x3(T a, T b, T c, T d, T e, T f) : m_glmMatrix(a, b, c, d, e, f) {}
+      Matrix2x3(const glm::mat<2, 3, T>& mat) : m_glmMatrix(mat) {}
 
       Matrix2x3<T> operator+(const Matrix2x3<T>& rhs) const { return Matrix2x3<T>(m_glmMatrix + rhs.m_glmMatrix); }
       Matrix2x3<T> operator-(const Matrix2x3<T>& rhs) const { return Matrix2x3<T>(m_glmMatrix - rhs.m_glmMatrix); }
@@ -103,9 +103,9 @@ namespace Cypher
    template<typename T>
    class Matrix2x4 : public GLMType<glm::mat<2, 4, T>>
    {
-      Matrix2x4<T>() : m_glmMatrix(static_cast<T>(1)) {}
-      Matrix2x4<T>(T a, T b, T c, T d, T e, T f, T g, T h) : m_glmMatrix(a, b, c, d, e, f, g, h) {}
-      Matrix2x4<T>(const glm::mat<2, 4, T>& mat) : m_glmMatrix(mat) {}
+      Matrix2x4() : m_glmMatrix(static_cast<T>(1)) {}
+      Matrix2x4(T a, T b, T c, T d, T e, T f, T g, T h) : m_glmMatrix(a, b, c, d, e, f, g, h) {}
+      Matrix2x4(const glm::mat<2, 4, T>& mat) : m_glmMatrix(mat) {}
 
       Matrix2x4<T> operator+(const Matrix2x4<T>& rhs) const { return Matrix2x4<T>(m_glmMatrix + rhs.m_glmMatrix); }
       Matrix2x4<T> operator-(const Matrix2x4<T>& rhs) const { return Matrix2x4<T>(m_glmMatrix - rhs.m_glmMatrix); }
@@ -145,9 +145,9 @@ namespace Cypher
    template<typename T>
    class Matrix3x2 : public GLMType<glm::mat<3, 2, T>>
    {
-      Matrix3x2<T>() : m_glmMatrix(static_cast<T>(1)) {}
-      Matrix3x2<T>(T a, T b, T c, T d, T e, T f) : m_glmMatrix(a, b, c, d, e, f) {}
-      Matrix3x2<T>(const glm::mat<3, 2, T>& mat) : m_glmMatrix(mat) {}
+      Matrix3x2() : m_glmMatrix(static_cast<T>(1)) {}
+      Matrix3x2(T a, T b, T c, T d, T e, T f) : m_glmMatrix(a, b, c, d, e, f) {}
+      Matrix3x2(const glm::mat<3, 2, T>& mat) : m_glmMatrix(mat) {}
 
       Matrix3x2<T> operator+(const Matrix3x2<T>& rhs) const { return Matrix3x2<T>(m_glmMatrix + rhs.m_glmMatrix); }
       Matrix3x2<T> operator-(const Matrix3x2<T>& rhs) const { return Matrix3x2<T>(m_glmMatrix - rhs.m_glmMatrix); }
@@ -187,9 +187,9 @@ namespace Cypher
    template<typename T>
    class Matrix3x3 : public GLMType<glm::mat<3, 3, T>>
    {
-      Matrix3x3<T>() : m_glmMatrix(static_cast<T>(1)) {}
-      Matrix3x3<T>(T a, T b, T c, T d, T e, T f, T g, T h, T i) : m_glmMatrix(a, b, c, d, e, f, g, h, i) {}
-      Matrix3x3<T>(const glm::mat<3, 3, T>& mat) : m_glmMatrix(mat) {}
+      Matrix3x3() : m_glmMatrix(static_cast<T>(1)) {}
+      Matrix3x3(T a, T b, T c, T d, T e, T f, T g, T h, T i) : m_glmMatrix(a, b, c, d, e, f, g, h, i) {}
+      Matrix3x3(const glm::mat<3, 3, T>& mat) : m_glmMatrix(mat) {}
 
       Matrix3x3<T> operator+(const Matrix3x3<T>& rhs) const { return Matrix3x3<T>(m_glmMatrix + rhs.m_glmMatrix); }
       Matrix3x3<T> operator-(const Matrix3x3<T>& rhs) const { return Matrix3x3<T>(m_glmMatrix - rhs.m_glmMatrix); }
@@ -229,9 +229,9 @@ namespace Cypher
    template<typename T>
    class Matrix3x4 : public GLMType<glm::mat<3, 4, T>>
    {
-      Matrix3x4<T>() : m_glmMatrix(static_cast<T>(1)) {}
-      Matrix3x4<T>(T a, T b, T c, T d, T e, T f, T g, T h, T i, T j, T k, T l) : m_glmMatrix(a, b, c, d, e, f, g, h, i, j, k, l) {}
-      Matrix3x4<T>(const glm::mat<3, 4, T>& mat) : m_glmMatrix(mat) {}
+      Matrix3x4() : m_glmMatrix(static_cast<T>(1)) {}
+      Matrix3x4(T a, T b, T c, T d, T e, T f, T g, T h, T i, T j, T k, T l) : m_glmMatrix(a, b, c, d, e, f, g, h, i, j, k, l) {}
+      Matrix3x4(const glm::mat<3, 4, T>& mat) : m_glmMatrix(mat) {}
 
       Matrix3x4<T> operator+(const Matrix3x4<T>& rhs) const { return Matrix3x4<T>(m_glmMatrix + rhs.m_glmMatrix); }
       Matrix3x4<T> operator-(const Matrix3x4<T>& rhs) const { return Matrix3x4<T>(m_glmMatrix - rhs.m_glmMatrix); }
@@ -266,9 +266,9 @@ namespace Cypher
    template<typename T>
    class Matrix4x2 : public GLMType<glm::mat<4, 2, T>>
    {
-      Matrix4x2<T>() : m_glmMatrix(static_cast<T>(1)) {}
-      Matrix4x2<T>(T a, T b, T c, T d, T e, T f, T g, T h) : m_glmMatrix(a, b, c, d, e, f, g, h) {}
-      Matrix4x2<T>(const glm::mat<4, 2, T>& mat) : m_glmMatrix(mat) {}
+      Matrix4x2() : m_glmMatrix(static_cast<T>(1)) {}
+      Matrix4x2(T a, T b, T c, T d, T e, T f, T g, T h) : m_glmMatrix(a, b, c, d, e, f, g, h) {}
+      Matrix4x2(const glm::mat<4, 2, T>& mat) : m_glmMatrix(mat) {}
 
       Matrix4x2<T> operator+(const Matrix4x2<T>& rhs) const { return Matrix4x2<T>(m_glmMatrix + rhs.m_glmMatrix); }
       Matrix4x2<T> operator-(const Matrix4x2<T>& rhs) const { return Matrix4x2<T>(m_glmMatrix - rhs.m_glmMatrix); }
@@ -303,9 +303,9 @@ namespace Cypher
    template<typename T>
    class Matrix4x3 : public GLMType<glm::mat<4, 3, T>>
    {
-      Matrix4x3<T>() : m_glmMatrix(static_cast<T>(1)) {}
-      Matrix4x3<T>(T a, T b, T c, T d, T e, T f, T g, T h, T i, T j, T k, T l) : m_glmMatrix(a, b, c, d, e, f, g, h, i, j, k, l) {}
-      Matrix4x3<T>(const glm::mat<4, 3, T>& mat) : m_glmMatrix(mat) {}
+      Matrix4x3() : m_glmMatrix(static_cast<T>(1)) {}
+      Matrix4x3(T a, T b, T c, T d, T e, T f, T g, T h, T i, T j, T k, T l) : m_glmMatrix(a, b, c, d, e, f, g, h, i, j, k, l) {}
+      Matrix4x3(const glm::mat<4, 3, T>& mat) : m_glmMatrix(mat) {}
 
       Matrix4x3<T> operator+(const Matrix4x3<T>& rhs) const { return Matrix4x3<T>(m_glmMatrix + rhs.m_glmMatrix); }
       Matrix4x3<T> operator-(const Matrix4x3<T>& rhs) const { return Matrix4x3<T>(m_glmMatrix - rhs.m_glmMatrix); }
@@ -340,9 +340,9 @@ namespace Cypher
    template<typename T>
    class Matrix4x4 : public GLMType<glm::mat<4, 4, T>>
    {
-      Matrix4x4<T>() : m_glmMatrix(static_cast<T>(1)) {}
-      Matrix4x4<T>(T a, T b, T c, T d, T e, T f, T g, T h, T i, T j, T k, T l, T m, T n, T o, T p) : m_glmMatrix(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p) {}
-      Matrix4x4<T>(const glm::mat<4, 4, T>& mat) : m_glmMatrix(mat) {}
+      Matrix4x4() : m_glmMatrix(static_cast<T>(1)) {}
+      Matrix4x4(T a, T b, T c, T d, T e, T f, T g, T h, T i, T j, T k, T l, T m, T n, T o, T p) : m_glmMatrix(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p) {}
+      Matrix4x4(const glm::mat<4, 4, T>& mat) : m_glmMatrix(mat) {}
 
       Matrix4x4<T> operator+(const Matrix4x4<T>& rhs) const { return Matrix4x4<T>(m_glmMatrix + rhs.m_glmMatrix); }
       Matrix4x4<T> operator-(const Matrix4x4<T>& rhs) const { return Matrix4x4<T>(m_glmMatrix - rhs.m_glmMatrix); }
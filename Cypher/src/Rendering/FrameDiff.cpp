@@ -0,0 +1,135 @@
+#include "FrameDiff.h"
+
+#include <cstring>
+
+namespace
+{
+   inline bool SameCells(const CHAR_INFO* a, const CHAR_INFO* b, size_t count)
+   {
+      return std::memcmp(a, b, count * sizeof(CHAR_INFO)) == 0;
+   }
+}
+
+Cypher::FrameDiff::FrameDiff() :
+   m_width(0),
+   m_height(0),
+   m_fullRedraw(true)
+{
+}
+
+void Cypher::FrameDiff::Resize(SHORT width, SHORT height)
+{
+   m_width = width;
+   m_height = height;
+   m_previous.assign(static_cast<size_t>(width) * height, CHAR_INFO{});
+   m_fullRedraw = true;
+}
+
+const std::vector<Cypher::DirtyRegion>& Cypher::FrameDiff::Diff(const CHAR_INFO* frame)
+{
+   m_regions.clear();
+   m_open.clear();
+
+   if (m_width <= 0 || m_height <= 0)
+   {
+      UpdateStats();
+      return m_regions;
+   }
+
+   if (m_fullRedraw)
+   {
+      std::memcpy(m_previous.data(), frame, m_previous.size() * sizeof(CHAR_INFO));
+      m_regions.push_back({ 0, 0, static_cast<SHORT>(m_width - 1), static_cast<SHORT>(m_height - 1) });
+      m_fullRedraw = false;
+      UpdateStats();
+      return m_regions;
+   }
+
+   for (SHORT y = 0; y < m_height; ++y)
+   {
+      m_nextOpen.clear();
+      DiffRow(frame, y);
+      m_open.swap(m_nextOpen);
+   }
+
+   UpdateStats();
+   return m_regions;
+}
+
+void Cypher::FrameDiff::DiffRow(const CHAR_INFO* frame, SHORT y)
+{
+   const CHAR_INFO* row = frame + static_cast<size_t>(y) * m_width;
+   const CHAR_INFO* previous = m_previous.data() + static_cast<size_t>(y) * m_width;
+   if (SameCells(row, previous, m_width))
+      return;
+
+   SHORT spanLeft = -1;
+   SHORT spanRight = -1;
+   for (SHORT block = 0; block < m_width; block += BLOCK_CELLS)
+   {
+      const SHORT blockEnd = m_width - block < BLOCK_CELLS ? m_width : block + BLOCK_CELLS;
+      if (SameCells(row + block, previous + block, blockEnd - block))
+         continue;
+
+      for (SHORT x = block; x < blockEnd; ++x)
+      {
+         if (SameCells(row + x, previous + x, 1))
+            continue;
+
+         if (spanLeft >= 0 && x - spanRight - 1 > SPLIT_GAP)
+         {
+            AddSpan(y, spanLeft, spanRight);
+            spanLeft = -1;
+         }
+         if (spanLeft < 0)
+            spanLeft = x;
+         spanRight = x;
+      }
+   }
+
+   if (spanLeft >= 0)
+      AddSpan(y, spanLeft, spanRight);
+
+   std::memcpy(m_previous.data() + static_cast<size_t>(y) * m_width, row, m_width * sizeof(CHAR_INFO));
+}
+
+void Cypher::FrameDiff::AddSpan(SHORT y, SHORT left, SHORT right)
+{
+   const int32_t spanWidth = right - left + 1;
+   for (size_t i = 0; i < m_open.size(); ++i)
+   {
+      DirtyRegion& region = m_regions[m_open[i]];
+      const SHORT unionLeft = region.left < left ? region.left : left;
+      const SHORT unionRight = region.right > right ? region.right : right;
+      const int32_t unionWidth = unionRight - unionLeft + 1;
+
+      // Unchanged cells the merge would rewrite: the padding on this row plus the widening of the rows above
+      const int32_t waste = (unionWidth - spanWidth) + (unionWidth - region.Width()) * region.Height();
+      if (waste > MERGE_SLACK)
+         continue;
+
+      region.left = unionLeft;
+      region.right = unionRight;
+      region.bottom = y;
+      m_nextOpen.push_back(m_open[i]);
+      m_open[i] = m_open.back();
+      m_open.pop_back();
+      return;
+   }
+
+   m_nextOpen.push_back(m_regions.size());
+   m_regions.push_back({ left, y, right, y });
+}
+
+void Cypher::FrameDiff::UpdateStats()
+{
+   uint32_t cells = 0;
+   for (const DirtyRegion& region : m_regions)
+      cells += static_cast<uint32_t>(region.Area());
+
+   m_stats.regionCount = static_cast<uint32_t>(m_regions.size());
+   m_stats.cellsWritten = cells;
+   m_stats.bytesWritten = cells * static_cast<uint32_t>(sizeof(CHAR_INFO));
+   m_stats.totalBytesWritten += m_stats.bytesWritten;
+   ++m_stats.frameCount;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Common.h"
+#include "Core/Platform.h"
+
+namespace Cypher
+{
+   // Rectangle of changed cells, inclusive on both ends like SMALL_RECT.
+   struct DirtyRegion
+   {
+      SHORT left;
+      SHORT top;
+      SHORT right;
+      SHORT bottom;
+
+      inline int32_t Width() const { return right - left + 1; }
+      inline int32_t Height() const { return bottom - top + 1; }
+      inline int32_t Area() const { return Width() * Height(); }
+      inline SMALL_RECT ToRect() const { return { left, top, right, bottom }; }
+   };
+
+   struct PresentStats
+   {
+      uint32_t regionCount = 0;     // Rectangles written last frame
+      uint32_t cellsWritten = 0;    // Cells written last frame, changed or not
+      uint32_t bytesWritten = 0;    // cellsWritten * sizeof(CHAR_INFO)
+      uint64_t totalBytesWritten = 0;
+      uint64_t frameCount = 0;
+   };
+
+   // Keeps the last presented frame and reports which parts of a new one differ from it. Rows are compared in blocks of
+   // cells with memcmp, which the C runtime vectorises, and only blocks that differ are scanned cell by cell. Changed
+   // cells are grouped into a span per row, split where a long run of unchanged cells makes two writes cheaper than
+   // one, and spans covering nearly the same columns on consecutive rows are merged into rectangles.
+   class FrameDiff
+   {
+   public:
+      static constexpr SHORT BLOCK_CELLS = 16;   // 64 bytes of CHAR_INFO
+      static constexpr SHORT SPLIT_GAP = 24;     // Unchanged cells worth a separate write rather than rewriting them
+      static constexpr SHORT MERGE_SLACK = 8;    // Unchanged cells per row a vertical merge may add
+
+      FrameDiff();
+
+      // Matches the diff to the screen size. Forces the next Diff to report the whole screen.
+      void Resize(SHORT width, SHORT height);
+
+      // Forces the next Diff to report the whole screen, e.g. after something else has drawn to the console.
+      inline void Invalidate() { m_fullRedraw = true; }
+
+      // Compares the frame with the last one, records it as presented and returns the regions to write. The result is
+      // valid until the next call.
+      const std::vector<DirtyRegion>& Diff(const CHAR_INFO* frame);
+
+      inline const PresentStats& GetStats() const { return m_stats; }
+
+   private:
+      void DiffRow(const CHAR_INFO* frame, SHORT y);
+      void AddSpan(SHORT y, SHORT left, SHORT right);
+      void UpdateStats();
+
+      SHORT m_width;
+      SHORT m_height;
+      bool m_fullRedraw;
+
+      std::vector<CHAR_INFO> m_previous;
+      std::vector<DirtyRegion> m_regions;
+      std::vector<size_t> m_open;      // Regions ending on the previous row, which may still grow downwards
+      std::vector<size_t> m_nextOpen;  // Regions ending on the current row
+
+      PresentStats m_stats;
+   };
+}
@@ -0,0 +1,101 @@
+#include "PolygonRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "SpanFill.h"
+
+void Cypher::PolygonRasterizer::Fill(std::span<const Vector2f> vertices, CHAR_INFO* buffer, SHORT width, SHORT height, CHAR_INFO cell)
+{
+   if (vertices.size() < 3 || width <= 0 || height <= 0)
+      return;
+
+   BuildEdgeTable(vertices, height);
+   if (m_edges.empty())
+      return;
+
+   // Crossings beyond the target are pinned just outside it, which keeps the conversion to an integer in range, even for
+   // a NaN from a degenerate vertex, without changing which cells the span covers
+   const float left = -1.0f;
+   const float right = static_cast<float>(width);
+
+   m_active.clear();
+   size_t next = 0;
+   int32_t row = m_edges.front().firstRow;
+   while (next < m_edges.size() || !m_active.empty())
+   {
+      // Skip rows no edge crosses
+      if (m_active.empty() && m_edges[next].firstRow > row)
+         row = m_edges[next].firstRow;
+
+      while (next < m_edges.size() && m_edges[next].firstRow == row)
+         m_active.push_back(static_cast<uint32_t>(next++));
+
+      m_crossings.clear();
+      for (size_t i = 0; i < m_active.size();)
+      {
+         const Edge& edge = m_edges[m_active[i]];
+         if (edge.lastRow < row)
+         {
+            m_active[i] = m_active.back();
+            m_active.pop_back();
+            continue;
+         }
+
+         float x = edge.originX + edge.slope * (static_cast<float>(row) - edge.originY);
+         x = x >= left ? (x <= right ? x : right) : left;
+         m_crossings.push_back(static_cast<int32_t>(x));
+         ++i;
+      }
+
+      // A row rarely has more than a handful of crossings, where insertion sort beats anything general
+      for (size_t i = 1; i < m_crossings.size(); ++i)
+      {
+         const int32_t crossing = m_crossings[i];
+         size_t j = i;
+         for (; j > 0 && m_crossings[j - 1] > crossing; --j)
+            m_crossings[j] = m_crossings[j - 1];
+         m_crossings[j] = crossing;
+      }
+
+      for (size_t i = 0; i + 1 < m_crossings.size(); i += 2)
+         FillSpan(buffer, width, height, m_crossings[i], m_crossings[i + 1], row, cell);
+
+      ++row;
+   }
+}
+
+void Cypher::PolygonRasterizer::BuildEdgeTable(std::span<const Vector2f> vertices, SHORT height)
+{
+   m_edges.clear();
+
+   const float top = -1.0f;
+   const float bottom = static_cast<float>(height);
+   for (size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++)
+   {
+      const Vector2f& origin = vertices[i];
+      const Vector2f& other = vertices[j];
+      if (origin.y() == other.y())
+         continue;
+
+      // Rows after the edge's smaller y up to and including its larger y, clipped to the target
+      float lower = origin.y() < other.y() ? origin.y() : other.y();
+      float upper = origin.y() < other.y() ? other.y() : origin.y();
+      lower = lower >= top ? (lower <= bottom ? lower : bottom) : top;
+      upper = upper >= top ? (upper <= bottom ? upper : bottom) : top;
+
+      int32_t firstRow = static_cast<int32_t>(std::floor(lower)) + 1;
+      int32_t lastRow = static_cast<int32_t>(std::floor(upper));
+      if (firstRow < 0)
+         firstRow = 0;
+      if (lastRow >= height)
+         lastRow = height - 1;
+      if (firstRow > lastRow)
+         continue;
+
+      const float slope = (other.x() - origin.x()) / (other.y() - origin.y());
+      m_edges.push_back({ firstRow, lastRow, origin.x(), origin.y(), slope });
+   }
+
+   std::sort(m_edges.begin(), m_edges.end(), [](const Edge& a, const Edge& b) { return a.firstRow < b.firstRow; });
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Common.h"
+#include "Core/Platform.h"
+#include "Math/Vector.h"
+
+namespace Cypher
+{
+   // Scanline polygon filler built on an edge table and an active-edge list. Edges are clipped to the target's rows when
+   // the table is built, so rows above or below the target cost nothing, and each row only visits the edges crossing it
+   // before filling the spans between them. The edge table, active list and row crossings live in buffers owned by the
+   // rasterizer and reused on every call, so once they have grown to the largest polygon seen, filling allocates nothing.
+   //
+   // An edge crosses the rows y with minY < y <= maxY, so a vertex shared by two edges is counted once. Crossings are
+   // truncated to cells and spans include both ends, with the even-odd rule deciding what is inside.
+   class PolygonRasterizer
+   {
+   public:
+      PolygonRasterizer() = default;
+
+      void Fill(std::span<const Vector2f> vertices, CHAR_INFO* buffer, SHORT width, SHORT height, CHAR_INFO cell);
+
+   private:
+      struct Edge
+      {
+         int32_t firstRow;   // Rows covered after clipping, inclusive
+         int32_t lastRow;
+         float originX;      // The edge's end the crossing is interpolated from
+         float originY;
+         float slope;        // Change in x per row
+      };
+
+      void BuildEdgeTable(std::span<const Vector2f> vertices, SHORT height);
+
+      std::vector<Edge> m_edges;       // Sorted by first row
+      std::vector<uint32_t> m_active;  // Edges crossing the current row
+      std::vector<int32_t> m_crossings;
+   };
+}
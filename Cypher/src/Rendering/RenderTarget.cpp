@@ -0,0 +1,310 @@
+#include "RenderTarget.h"
+
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#include "SpanFill.h"
+#include "Core/Memory.h"
+#include "Util/StringUtil.h"
+
+namespace
+{
+   constexpr size_t HEADER_SIZE = 10;   // Magic, version, width, height
+   constexpr size_t RUN_SIZE = 6;       // Count, glyph, attributes
+   constexpr uint32_t MAX_RUN = 0xFFFF;
+
+   FILE* OpenFile(const std::wstring& path, bool write)
+   {
+#ifdef _WIN32
+      FILE* file = nullptr;
+      _wfopen_s(&file, path.c_str(), write ? L"wb" : L"rb");
+      return file;
+#else
+      return std::fopen(Cypher::StringUtil::ToString(path).c_str(), write ? "wb" : "rb");
+#endif
+   }
+
+   inline bool SameCell(const CHAR_INFO& a, const CHAR_INFO& b)
+   {
+      return a.Char.UnicodeChar == b.Char.UnicodeChar && a.Attributes == b.Attributes;
+   }
+
+   inline void Write16(std::vector<uint8_t>& out, uint16_t value)
+   {
+      out.push_back(static_cast<uint8_t>(value & 0xFF));
+      out.push_back(static_cast<uint8_t>(value >> 8));
+   }
+
+   inline uint16_t Read16(const uint8_t* in)
+   {
+      return static_cast<uint16_t>(in[0] | (in[1] << 8));
+   }
+
+   inline char HexDigit(uint32_t value)
+   {
+      return "0123456789abcdef"[value & 0xF];
+   }
+}
+
+Cypher::RenderTarget::RenderTarget() :
+   m_width(0),
+   m_height(0),
+   m_cells(nullptr)
+{
+}
+
+Cypher::RenderTarget::RenderTarget(SHORT width, SHORT height) :
+   m_width(0),
+   m_height(0),
+   m_cells(nullptr)
+{
+   Resize(width, height);
+}
+
+Cypher::RenderTarget::RenderTarget(const RenderTarget& other) :
+   m_width(0),
+   m_height(0),
+   m_cells(nullptr)
+{
+   *this = other;
+}
+
+Cypher::RenderTarget::RenderTarget(RenderTarget&& other) noexcept :
+   m_width(std::exchange(other.m_width, SHORT(0))),
+   m_height(std::exchange(other.m_height, SHORT(0))),
+   m_cells(std::exchange(other.m_cells, nullptr))
+{
+}
+
+Cypher::RenderTarget::~RenderTarget()
+{
+   Release();
+}
+
+Cypher::RenderTarget& Cypher::RenderTarget::operator=(const RenderTarget& other)
+{
+   if (this != &other)
+   {
+      if (m_width != other.m_width || m_height != other.m_height)
+         Allocate(other.m_width, other.m_height);
+      if (m_cells)
+         std::memcpy(m_cells, other.m_cells, static_cast<size_t>(m_width) * m_height * sizeof(CHAR_INFO));
+   }
+
+   return *this;
+}
+
+Cypher::RenderTarget& Cypher::RenderTarget::operator=(RenderTarget&& other) noexcept
+{
+   if (this != &other)
+   {
+      Release();
+      m_width = std::exchange(other.m_width, SHORT(0));
+      m_height = std::exchange(other.m_height, SHORT(0));
+      m_cells = std::exchange(other.m_cells, nullptr);
+   }
+
+   return *this;
+}
+
+void Cypher::RenderTarget::Resize(SHORT width, SHORT height)
+{
+   Allocate(width, height);
+   Clear();
+}
+
+void Cypher::RenderTarget::Clear(WCHAR glyph, WORD attributes)
+{
+   if (m_cells)
+      FillCells(m_cells, static_cast<size_t>(m_width) * m_height, MakeCell(static_cast<SHORT>(glyph), static_cast<SHORT>(attributes)));
+}
+
+CHAR_INFO Cypher::RenderTarget::GetCell(SHORT x, SHORT y) const
+{
+   if (x < 0 || x >= m_width || y < 0 || y >= m_height)
+   {
+      CHAR_INFO blank{};
+      blank.Char.UnicodeChar = ' ';
+      return blank;
+   }
+   return m_cells[static_cast<size_t>(y) * m_width + x];
+}
+
+size_t Cypher::RenderTarget::CountDifferences(const RenderTarget& other) const
+{
+   const size_t area = static_cast<size_t>(m_width) * m_height;
+   if (m_width != other.m_width || m_height != other.m_height)
+   {
+      const size_t otherArea = static_cast<size_t>(other.m_width) * other.m_height;
+      return area > otherArea ? area : otherArea;
+   }
+
+   size_t differences = 0;
+   for (size_t i = 0; i < area; ++i)
+   {
+      if (!SameCell(m_cells[i], other.m_cells[i]))
+         ++differences;
+   }
+   return differences;
+}
+
+std::vector<uint8_t> Cypher::RenderTarget::Snapshot() const
+{
+   std::vector<uint8_t> out;
+   out.reserve(HEADER_SIZE + RUN_SIZE * m_height);
+   Write16(out, static_cast<uint16_t>(SNAPSHOT_MAGIC & 0xFFFF));
+   Write16(out, static_cast<uint16_t>(SNAPSHOT_MAGIC >> 16));
+   Write16(out, SNAPSHOT_VERSION);
+   Write16(out, static_cast<uint16_t>(m_width));
+   Write16(out, static_cast<uint16_t>(m_height));
+
+   const size_t area = static_cast<size_t>(m_width) * m_height;
+   size_t i = 0;
+   while (i < area)
+   {
+      const CHAR_INFO& cell = m_cells[i];
+      size_t end = i + 1;
+      while (end < area && end - i < MAX_RUN && SameCell(m_cells[end], cell))
+         ++end;
+
+      Write16(out, static_cast<uint16_t>(end - i));
+      Write16(out, static_cast<uint16_t>(cell.Char.UnicodeChar));
+      Write16(out, cell.Attributes);
+      i = end;
+   }
+
+   return out;
+}
+
+bool Cypher::RenderTarget::Restore(std::span<const uint8_t> snapshot)
+{
+   if (snapshot.size() < HEADER_SIZE)
+      return false;
+
+   const uint8_t* data = snapshot.data();
+   const uint32_t magic = Read16(data) | (static_cast<uint32_t>(Read16(data + 2)) << 16);
+   const SHORT width = static_cast<SHORT>(Read16(data + 6));
+   const SHORT height = static_cast<SHORT>(Read16(data + 8));
+   if (magic != SNAPSHOT_MAGIC || Read16(data + 4) != SNAPSHOT_VERSION || width < 0 || height < 0)
+      return false;
+
+   // Validate the runs before touching the cells so a bad snapshot leaves the target as it was
+   const size_t area = static_cast<size_t>(width) * height;
+   size_t covered = 0;
+   size_t offset = HEADER_SIZE;
+   for (; offset + RUN_SIZE <= snapshot.size() && covered < area; offset += RUN_SIZE)
+   {
+      const uint16_t count = Read16(data + offset);
+      if (count == 0)
+         return false;
+      covered += count;
+   }
+   if (covered != area || offset != snapshot.size())
+      return false;
+
+   if (width != m_width || height != m_height)
+      Allocate(width, height);
+
+   size_t cell = 0;
+   for (offset = HEADER_SIZE; offset < snapshot.size(); offset += RUN_SIZE)
+   {
+      const uint16_t count = Read16(data + offset);
+      FillCells(m_cells + cell, count, MakeCell(static_cast<SHORT>(Read16(data + offset + 2)), static_cast<SHORT>(Read16(data + offset + 4))));
+      cell += count;
+   }
+
+   return true;
+}
+
+bool Cypher::RenderTarget::Save(const std::wstring& path) const
+{
+   FILE* file = OpenFile(path, true);
+   if (!file)
+      return false;
+
+   const std::vector<uint8_t> snapshot = Snapshot();
+   const bool written = std::fwrite(snapshot.data(), 1, snapshot.size(), file) == snapshot.size();
+   std::fclose(file);
+   return written;
+}
+
+bool Cypher::RenderTarget::Load(const std::wstring& path)
+{
+   FILE* file = OpenFile(path, false);
+   if (!file)
+      return false;
+
+   std::vector<uint8_t> snapshot;
+   uint8_t chunk[4096];
+   size_t read = 0;
+   while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+      snapshot.insert(snapshot.end(), chunk, chunk + read);
+   std::fclose(file);
+
+   return Restore(snapshot);
+}
+
+std::string Cypher::RenderTarget::ToText() const
+{
+   std::string text;
+   text.reserve(static_cast<size_t>(m_width) * m_height * 6 + 2 * m_height + 1);
+
+   for (SHORT y = 0; y < m_height; ++y)
+   {
+      const CHAR_INFO* row = m_cells + static_cast<size_t>(y) * m_width;
+      for (SHORT x = 0; x < m_width; ++x)
+      {
+         // Control characters and lone surrogates would break the line layout or the encoding
+         uint32_t glyph = static_cast<uint16_t>(row[x].Char.UnicodeChar);
+         if (glyph == 0)
+            glyph = ' ';
+         else if (glyph < 0x20 || glyph == 0x7F || (glyph >= 0xD800 && glyph <= 0xDFFF))
+            glyph = '?';
+         StringUtil::AppendUTF8(text, glyph);
+      }
+      text += '\n';
+   }
+
+   text += '\n';
+
+   for (SHORT y = 0; y < m_height; ++y)
+   {
+      const CHAR_INFO* row = m_cells + static_cast<size_t>(y) * m_width;
+      for (SHORT x = 0; x < m_width; ++x)
+      {
+         const WORD attributes = row[x].Attributes;
+         if (x > 0)
+            text += ' ';
+         text += HexDigit(attributes >> 12);
+         text += HexDigit(attributes >> 8);
+         text += HexDigit(attributes >> 4);
+         text += HexDigit(attributes);
+      }
+      text += '\n';
+   }
+
+   return text;
+}
+
+void Cypher::RenderTarget::Allocate(SHORT width, SHORT height)
+{
+   Release();
+   if (width <= 0 || height <= 0)
+      return;
+
+   const size_t area = static_cast<size_t>(width) * height;
+   m_cells = static_cast<CHAR_INFO*>(Memory::Allocate(area * sizeof(CHAR_INFO), alignof(CHAR_INFO), MemoryArena::Rendering));
+   m_width = width;
+   m_height = height;
+}
+
+void Cypher::RenderTarget::Release()
+{
+   if (m_cells)
+      Memory::Deallocate(m_cells, static_cast<size_t>(m_width) * m_height * sizeof(CHAR_INFO), alignof(CHAR_INFO), MemoryArena::Rendering);
+
+   m_width = 0;
+   m_height = 0;
+   m_cells = nullptr;
+}
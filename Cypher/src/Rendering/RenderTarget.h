@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "Common.h"
+#include "Core/Platform.h"
+
+namespace Cypher
+{
+   // Off-screen cell surface with the same layout as the console buffer. A TextRenderer constructed on one draws into it
+   // exactly as it would draw to the screen, with no console or terminal involved, so frames can be rendered, compared
+   // and snapshotted on a headless machine.
+   //
+   // Snapshots are little-endian: the magic "CYRT", a version, the width and height, then runs of identical cells in
+   // row-major order, each a count, a glyph and attributes, all 16-bit.
+   class RenderTarget
+   {
+   public:
+      static constexpr uint32_t SNAPSHOT_MAGIC = 0x54525943;   // "CYRT"
+      static constexpr uint16_t SNAPSHOT_VERSION = 1;
+
+      RenderTarget();
+      RenderTarget(SHORT width, SHORT height);
+      RenderTarget(const RenderTarget& other);
+      RenderTarget(RenderTarget&& other) noexcept;
+
+      ~RenderTarget();
+
+      RenderTarget& operator=(const RenderTarget& other);
+      RenderTarget& operator=(RenderTarget&& other) noexcept;
+
+      // Contents are cleared. A TextRenderer bound to the target follows the new size.
+      void Resize(SHORT width, SHORT height);
+      void Clear(WCHAR glyph = ' ', WORD attributes = 0);
+
+      inline SHORT GetWidth() const { return m_width; }
+      inline SHORT GetHeight() const { return m_height; }
+      inline CHAR_INFO* GetCells() { return m_cells; }
+      inline const CHAR_INFO* GetCells() const { return m_cells; }
+
+      // Returns a blank cell outside the surface.
+      CHAR_INFO GetCell(SHORT x, SHORT y) const;
+
+      // Cells that differ from the other target, or every cell of the larger one if the sizes differ.
+      size_t CountDifferences(const RenderTarget& other) const;
+
+      std::vector<uint8_t> Snapshot() const;
+      // Leaves the target untouched and returns false if the data is not a complete snapshot.
+      bool Restore(std::span<const uint8_t> snapshot);
+
+      bool Save(const std::wstring& path) const;
+      bool Load(const std::wstring& path);
+
+      // Glyphs as UTF-8, one line per row, then a blank line and the attributes as four hex digits per cell. Meant for
+      // readable golden files and test failure output.
+      std::string ToText() const;
+
+   private:
+      friend class TextRenderer;
+
+      void Allocate(SHORT width, SHORT height);
+      void Release();
+
+      SHORT m_width;
+      SHORT m_height;
+      CHAR_INFO* m_cells;
+   };
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "Common.h"
+#include "Core/Platform.h"
+
+#if defined(__AVX2__)
+   #define CYPHER_SPAN_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+   #define CYPHER_SPAN_SSE2
+#endif
+#if defined(CYPHER_SPAN_AVX2) || defined(CYPHER_SPAN_SSE2)
+   #include <immintrin.h>
+#endif
+
+namespace Cypher
+{
+   static_assert(sizeof(CHAR_INFO) == sizeof(uint32_t), "Span fills treat a cell as one 32-bit word");
+
+   inline CHAR_INFO MakeCell(SHORT glyph, SHORT color)
+   {
+      CHAR_INFO cell{};
+      cell.Char.UnicodeChar = static_cast<WCHAR>(glyph);
+      cell.Attributes = static_cast<WORD>(color);
+      return cell;
+   }
+
+   // Writes count copies of a cell. The cell is broadcast to a vector register once and stored 8 (AVX2) or 4 (SSE2)
+   // cells at a time with unaligned stores; the remainder is written one cell at a time. Callers clip beforehand.
+   inline void FillCells(CHAR_INFO* destination, size_t count, CHAR_INFO cell)
+   {
+      uint32_t pattern;
+      std::memcpy(&pattern, &cell, sizeof(pattern));
+
+      size_t i = 0;
+#ifdef CYPHER_SPAN_AVX2
+      const __m256i wide = _mm256_set1_epi32(static_cast<int>(pattern));
+      for (; i + 8 <= count; i += 8)
+         _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), wide);
+#endif
+#ifdef CYPHER_SPAN_SSE2
+      const __m128i narrow = _mm_set1_epi32(static_cast<int>(pattern));
+      for (; i + 4 <= count; i += 4)
+         _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), narrow);
+#endif
+      for (; i < count; ++i)
+         std::memcpy(destination + i, &pattern, sizeof(pattern));
+   }
+
+   // Fills the cells x0..x1 inclusive of row y in a width * height buffer, clipped to it. Reversed ends are swapped.
+   inline void FillSpan(CHAR_INFO* buffer, SHORT width, SHORT height, int32_t x0, int32_t x1, int32_t y, CHAR_INFO cell)
+   {
+      if (y < 0 || y >= height)
+         return;
+      if (x0 > x1)
+      {
+         const int32_t swap = x0;
+         x0 = x1;
+         x1 = swap;
+      }
+      if (x0 < 0)
+         x0 = 0;
+      if (x1 >= width)
+         x1 = width - 1;
+      if (x0 > x1)
+         return;
+
+      FillCells(buffer + static_cast<size_t>(y) * width + x0, static_cast<size_t>(x1 - x0 + 1), cell);
+   }
+}
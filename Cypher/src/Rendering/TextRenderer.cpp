@@ -7,6 +7,8 @@
 #include <tuple>
 #include <vector>
 
+#include "SpanFill.h"
+
 Cypher::TextRenderer::TextRenderer(SHORT& screenWidth, SHORT& screenHeight, Buffer& screenBuffer) :
 	m_screenBuffer(screenBuffer),
 	m_screenWidth(screenWidth),
@@ -14,9 +16,17 @@ Cypher::TextRenderer::TextRenderer(SHORT& screenWidth, SHORT& screenHeight, Buff
 {
 }
 
+Cypher::TextRenderer::TextRenderer(RenderTarget& target) :
+	m_screenBuffer(target.m_cells),
+	m_screenWidth(target.m_width),
+	m_screenHeight(target.m_height)
+{
+}
+
 void Cypher::TextRenderer::Clear()
 {
-	Fill(static_cast<SHORT>(0), static_cast<SHORT>(0), m_screenWidth, m_screenHeight, Pixel::FULL, static_cast<SHORT>(0));
+	if (m_screenWidth > 0 && m_screenHeight > 0)
+		FillCells(m_screenBuffer, static_cast<size_t>(m_screenWidth) * m_screenHeight, MakeCell(static_cast<SHORT>(Pixel::FULL), 0));
 }
 
 void Cypher::TextRenderer::Draw(SHORT x, SHORT y, SHORT glyph, SHORT color)
@@ -33,12 +43,13 @@ void Cypher::TextRenderer::Fill(SHORT x0, SHORT y0, SHORT x1, SHORT y1, SHORT gl
 	Clip(x0, y0);
 	Clip(x1, y1);
 
-	for (SHORT x = x0; x < x1; ++x)
+	if (x0 >= x1)
+		return;
+
+	const CHAR_INFO cell = MakeCell(glyph, color);
+	for (SHORT y = y0; y < y1; ++y)
 	{
-		for (SHORT y = y0; y < y1; ++y)
-		{
-			Draw(x, y, glyph, color);
-		}
+		FillCells(m_screenBuffer + static_cast<size_t>(y) * m_screenWidth + x0, static_cast<size_t>(x1 - x0), cell);
 	}
 }
 
@@ -53,6 +64,10 @@ void Cypher::TextRenderer::DrawString(SHORT x, SHORT y, std::wstring string, SHO
 
 void Cypher::TextRenderer::DrawLine(SHORT x0, SHORT y0, SHORT x1, SHORT y1, SHORT glyph, SHORT color)
 {
+	// Every cell of the line lies within its endpoints' bounds, so a line entirely off one side draws nothing
+	if ((x0 < 0 && x1 < 0) || (y0 < 0 && y1 < 0) || (x0 >= m_screenWidth && x1 >= m_screenWidth) || (y0 >= m_screenHeight && y1 >= m_screenHeight))
+		return;
+
 	SHORT dx = std::abs(x1 - x0);
 	SHORT dy = -std::abs(y1 - y0);
 	SHORT sx = x0 < x1 ? 1 : -1;
@@ -113,12 +128,13 @@ void Cypher::TextRenderer::DrawRectangle(SHORT x, SHORT y, SHORT width, SHORT he
 
 void Cypher::TextRenderer::FillRectangle(SHORT x, SHORT y, SHORT width, SHORT height, SHORT glyph, SHORT color)
 {
-	for (SHORT yi = 0; yi < height; ++yi)
+	if (width <= 0 || height <= 0)
+		return;
+
+	const int32_t y1 = (y + height < m_screenHeight) ? y + height : m_screenHeight;
+	for (int32_t row = (y < 0) ? 0 : y; row < y1; ++row)
 	{
-		for (SHORT xi = 0; xi < width; ++xi)
-		{
-			Draw(x + xi, y + yi, glyph, color);
-		}
+		FillSpan(x, x + width - 1, row, glyph, color);
 	}
 }
 
@@ -169,20 +185,12 @@ void Cypher::TextRenderer::FillCircle(SHORT centerX, SHORT centerY, SHORT radius
 	SHORT y = radius;
 	SHORT p = 3 - 2 * radius;
 
-	auto drawScanLine = [&](SHORT startX, SHORT endX, SHORT y)
-	{
-		for (SHORT x = startX; x <= endX; ++x)
-		{
-			Draw(x, y, glyph, color);
-		}
-	};
-
 	while (y >= x)
 	{
-		drawScanLine(centerX - x, centerX + x, centerY - y);
-		drawScanLine(centerX - y, centerX + y, centerY - x);
-		drawScanLine(centerX - x, centerX + x, centerY + y);
-		drawScanLine(centerX - y, centerX + y, centerY + x);
+		FillSpan(centerX - x, centerX + x, centerY - y, glyph, color);
+		FillSpan(centerX - y, centerX + y, centerY - x, glyph, color);
+		FillSpan(centerX - x, centerX + x, centerY + y, glyph, color);
+		FillSpan(centerX - y, centerX + y, centerY + x, glyph, color);
 
 		if (p < 0)
 			p += 4 * x++ + 6;
@@ -193,48 +201,9 @@ void Cypher::TextRenderer::FillCircle(SHORT centerX, SHORT centerY, SHORT radius
 
 void Cypher::TextRenderer::DrawTriangle(SHORT x0, SHORT y0, SHORT x1, SHORT y1, SHORT x2, SHORT y2, SHORT glyph, SHORT color)
 {
-	auto interpolate = [](SHORT x0, SHORT y0, SHORT x1, SHORT y1) -> std::vector<std::pair<SHORT, SHORT>>
-	{
-		std::vector<std::pair<SHORT, SHORT>> points;
-
-		SHORT dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
-		SHORT dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
-		SHORT err = dx + dy, e2;
-
-		while (true)
-		{
-			points.push_back(std::make_pair(x0, y0));
-			if (x0 == x1 && y0 == y1)
-				break;
-
-			e2 = 2 * err;
-			
-			if (e2 >= dy)
-			{
-				err += dy;
-				x0 += sx;
-			}
-			if (e2 <= dx)
-			{
-				err += dx;
-				y0 += sy;
-			}
-		}
-
-		return points;
-	};
-
-	auto edge1 = interpolate(x0, y0, x1, y1);
-	auto edge2 = interpolate(x1, y1, x2, y2);
-	auto edge3 = interpolate(x2, y2, x0, y0);
-
-	edge1.insert(edge1.end(), edge2.begin(), edge2.end());
-	edge1.insert(edge1.end(), edge3.begin(), edge3.end());
-
-	for (const auto& [x, y] : edge1)
-	{
-		Draw(x, y, glyph, color);
-	}
+	DrawLine(x0, y0, x1, y1, glyph, color);
+	DrawLine(x1, y1, x2, y2, glyph, color);
+	DrawLine(x2, y2, x0, y0, glyph, color);
 }
 
 void Cypher::TextRenderer::FillTriangle(SHORT x0, SHORT y0, SHORT x1, SHORT y1, SHORT x2, SHORT y2, SHORT glyph, SHORT color)
@@ -246,13 +215,11 @@ void Cypher::TextRenderer::FillTriangle(SHORT x0, SHORT y0, SHORT x1, SHORT y1,
 	if (y1 > y2)
 		std::tie(x1, y1, x2, y2) = std::make_tuple(x2, y2, x1, y1);
 
-	auto drawScanLine = [&](SHORT startX, SHORT endX, SHORT y)
-	{
-		for (SHORT x = startX; x <= endX; ++x)
-		{
-			Draw(x, y, glyph, color);
-		}
-	};
+	// A triangle entirely off the screen is rejected here, and the row walk below stops at the bottom of the screen
+	const SHORT minX = (x0 < x1) ? ((x0 < x2) ? x0 : x2) : ((x1 < x2) ? x1 : x2);
+	const SHORT maxX = (x0 > x1) ? ((x0 > x2) ? x0 : x2) : ((x1 > x2) ? x1 : x2);
+	if (y2 < 0 || y0 >= m_screenHeight || maxX < 0 || minX >= m_screenWidth)
+		return;
 
 	auto [dx1, signx1, dy1] = std::make_tuple(std::abs(x1 - x0), (x1 - x0) > 0 ? 1 : -1, y1 - y0);
 	auto [dx2, signx2, dy2] = std::make_tuple(std::abs(x2 - x0), (x2 - x0) > 0 ? 1 : -1, y2 - y0);
@@ -308,20 +275,20 @@ void Cypher::TextRenderer::FillTriangle(SHORT x0, SHORT y0, SHORT x1, SHORT y1,
 			}
 			minx = std::min<SHORT>(minx, std::min<SHORT>(t1x, t2x));
 			maxx = std::max<SHORT>(maxx, std::max<SHORT>(t1x, t2x));
-			drawScanLine(minx, maxx, y);
+			FillSpan(minx, maxx, y, glyph, color);
 
 			t1x += (changed1 ? t1xp : signx1 + t1xp);
 			t2x += (changed2 ? t2xp : signx2 + t2xp);
 			y += 1;
 
-			if (y == y1)
+			if (y == y1 || y >= m_screenHeight)
 				break;
 		}
 	};
 
 	drawHalf();
 	
-	if (y0 != y1)
+	if (y0 != y1 && y < m_screenHeight)
 	{	
 		dx1 = std::abs(x2 - x1);
 		dy1 = y2 - y1;
@@ -338,101 +305,67 @@ void Cypher::TextRenderer::FillTriangle(SHORT x0, SHORT y0, SHORT x1, SHORT y1,
 
 void Cypher::TextRenderer::DrawPolygon(const std::vector<Vector2f>& vertices, SHORT x, SHORT y, float rotation, float scale, SHORT glyph, SHORT color)
 {
-	if (vertices.empty())
-		return;
-
-	std::vector<Vector2f> transformedVerticeList;
-	const size_t verticeCount = vertices.size();
-	transformedVerticeList.reserve(verticeCount);
-
-	const float cosTheta = cosf(rotation);
-	const float sinTheta = sinf(rotation);
-
-	for (const auto& vertex : vertices)
-	{
-		const float transformedX = (vertex.x() * cosTheta - vertex.y() * sinTheta) * scale + x;
-		const float transformedY = (vertex.y() * cosTheta + vertex.x() * sinTheta) * scale + y;
-		transformedVerticeList.emplace_back(transformedX, transformedY);
-	}
+	const std::span<const Vector2f> transformed = TransformVertices(vertices, x, y, rotation, scale);
 
-	for (size_t i = 0; i < verticeCount; ++i)
+	for (size_t i = 0; i < transformed.size(); ++i)
 	{
-		size_t nextIndex = (i + 1) % verticeCount;
-		DrawLine(static_cast<SHORT>(transformedVerticeList[i].x()),
-					static_cast<SHORT>(transformedVerticeList[i].y()),
-					static_cast<SHORT>(transformedVerticeList[nextIndex].x()),
-					static_cast<SHORT>(transformedVerticeList[nextIndex].y()),
+		size_t nextIndex = (i + 1) % transformed.size();
+		DrawLine(static_cast<SHORT>(transformed[i].x()),
+					static_cast<SHORT>(transformed[i].y()),
+					static_cast<SHORT>(transformed[nextIndex].x()),
+					static_cast<SHORT>(transformed[nextIndex].y()),
 					glyph, color);
 	}
 }
 
-void Cypher::TextRenderer::FillPolygon(const std::vector<Vector2f>& verticeList, SHORT x, SHORT y, float rotation, float scale, SHORT glyph, SHORT color)
+void Cypher::TextRenderer::FillPolygon(const std::vector<Vector2f>& vertices, SHORT x, SHORT y, float rotation, float scale, SHORT glyph, SHORT color)
 {
-	const float cosTheta = cosf(rotation);
-	const float sinTheta = sinf(rotation);
+	m_rasterizer.Fill(TransformVertices(vertices, x, y, rotation, scale), m_screenBuffer, m_screenWidth, m_screenHeight, MakeCell(glyph, color));
+}
 
-	std::vector<Vector2f> transformedVertices;
-	for (const auto& vertex : verticeList)
-	{
-		Vector2f transformed;
-		transformed.x() = (vertex.x() * cosTheta - vertex.y() * sinTheta) * scale + x;
-		transformed.y() = (vertex.x() * sinTheta + vertex.y() * cosTheta) * scale + y;
-		transformedVertices.push_back(transformed);
-	}
+void Cypher::TextRenderer::DrawSprite(SHORT x, SHORT y, const Sprite& sprite)
+{
+	const int32_t width = sprite.GetWidth();
+	const int32_t left = (x < 0) ? -x : 0;
+	const int32_t right = (x + width > m_screenWidth) ? m_screenWidth - x : width;
+	const int32_t top = (y < 0) ? -y : 0;
+	const int32_t bottom = (y + sprite.GetHeight() > m_screenHeight) ? m_screenHeight - y : sprite.GetHeight();
+	if (left >= right || top >= bottom)
+		return;
 
-	auto drawScanLine = [&](SHORT startX, SHORT endX, SHORT y)
+	// Clipped once up front, so the rows are copied without per-cell bounds checks
+	for (int32_t row = top; row < bottom; ++row)
 	{
-		for (SHORT x = startX; x <= endX; ++x)
+		const SHORT* glyphs = sprite.GetGlyphs() + static_cast<size_t>(row) * width;
+		const SHORT* colors = sprite.GetColors() + static_cast<size_t>(row) * width;
+		CHAR_INFO* destination = m_screenBuffer + static_cast<size_t>(y + row) * m_screenWidth + x;
+		for (int32_t column = left; column < right; ++column)
 		{
-			Draw(x, y, glyph, color);
+			if (glyphs[column] != ' ')
+				destination[column] = MakeCell(glyphs[column], colors[column]);
 		}
-	};
-
-	SHORT minX = 0;
-	SHORT maxX = 0;
-	SHORT minY = 0;
-	SHORT maxY = 0;
-	for (const auto& vertex : transformedVertices)
-	{
-		minX = std::min<SHORT>(minX, static_cast<SHORT>(vertex.x()));
-		maxX = std::max<SHORT>(maxX, static_cast<SHORT>(vertex.x()));
-		minY = std::min<SHORT>(minY, static_cast<SHORT>(vertex.y()));
-		maxY = std::max<SHORT>(maxY, static_cast<SHORT>(vertex.y()));
 	}
+}
 
-	for (SHORT scanY = minY; scanY <= maxY; ++scanY)
-	{
-		std::vector<SHORT> nodeX;
-		for (size_t i = 0, j = transformedVertices.size() - 1; i < transformedVertices.size(); j = i++)
-		{
-			const auto& vCurrent = transformedVertices[i];
-			const auto& vPrevious = transformedVertices[j];
+std::span<const Cypher::Vector2f> Cypher::TextRenderer::TransformVertices(const std::vector<Vector2f>& vertices, SHORT x, SHORT y, float rotation, float scale)
+{
+	const float cosTheta = cosf(rotation);
+	const float sinTheta = sinf(rotation);
 
-			if (vCurrent.y() < scanY && vPrevious.y() >= scanY || vPrevious.y() < scanY && vCurrent.y() >= scanY)
-			{
-				float slope = (vPrevious.x() - vCurrent.x()) / (vPrevious.y() - vCurrent.y());
-				float deltaX = slope * (scanY - vCurrent.y());
-				SHORT node = static_cast<SHORT>(vCurrent.x() + deltaX);
-				nodeX.push_back(node);
-			}
-		}
+	m_transformed.clear();
+	for (const auto& vertex : vertices)
+	{
+		const float transformedX = (vertex.x() * cosTheta - vertex.y() * sinTheta) * scale + x;
+		const float transformedY = (vertex.x() * sinTheta + vertex.y() * cosTheta) * scale + y;
+		m_transformed.emplace_back(transformedX, transformedY);
+	}
 
-		std::sort(nodeX.begin(), nodeX.end());
+	return m_transformed;
+}
 
-		for (size_t i = 0; i + 1 < nodeX.size(); i += 2)
-		{
-			const auto& vCurrent = nodeX[i];
-			if (vCurrent > maxX)
-				continue;
-			const auto& vNext = nodeX[i + 1];
-			if (vNext > minX)
-			{
-				SHORT startX = std::max<SHORT>(minX, vCurrent);
-				SHORT startY = std::min<SHORT>(maxX, vNext);
-				drawScanLine(startX, startY, scanY);
-			}
-		}
-	}
+void Cypher::TextRenderer::FillSpan(int32_t x0, int32_t x1, int32_t y, SHORT glyph, SHORT color)
+{
+	Cypher::FillSpan(m_screenBuffer, m_screenWidth, m_screenHeight, x0, x1, y, MakeCell(glyph, color));
 }
 
 void Cypher::TextRenderer::Clip(SHORT& x, SHORT& y)
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <cwctype>
 #include <locale>
 #include <string>
@@ -180,3 +181,29 @@ std::wstring Cypher::StringUtil::ToWString(const std::string& str)
 #endif
    return result;
 }
+
+void Cypher::StringUtil::AppendUTF8(std::string& str, uint32_t codePoint)
+{
+   if (codePoint < 0x80)
+   {
+      str += static_cast<char>(codePoint);
+   }
+   else if (codePoint < 0x800)
+   {
+      str += static_cast<char>(0xC0 | (codePoint >> 6));
+      str += static_cast<char>(0x80 | (codePoint & 0x3F));
+   }
+   else if (codePoint < 0x10000)
+   {
+      str += static_cast<char>(0xE0 | (codePoint >> 12));
+      str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      str += static_cast<char>(0x80 | (codePoint & 0x3F));
+   }
+   else
+   {
+      str += static_cast<char>(0xF0 | (codePoint >> 18));
+      str += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+      str += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+      str += static_cast<char>(0x80 | (codePoint & 0x3F));
+   }
+}
@@ -38,5 +38,8 @@ namespace Cypher
 
       std::string ToString(const std::wstring& str);
       std::wstring ToWString(const std::string& str);
+
+      // Appends the UTF-8 encoding of a code point, which must be a valid scalar value.
+      void AppendUTF8(std::string& str, uint32_t codePoint);
    } // namespace StringUtil
 } // namespace Cypher
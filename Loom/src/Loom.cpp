@@ -1,6 +1,7 @@
 #include "Loom.h"
 
 #include "Console.h"
+#include "Core/Profiler.h"
 #include "Module/ModuleLoader.h"
 #include "Module/ModuleContext.h"
 
@@ -17,12 +18,13 @@ Cypher::Loom::~Loom()
    }
 }
 
-void Cypher::Loom::Initialize()
+bool Cypher::Loom::Initialize()
 {
+   CYPHER_PROFILE_SCOPE("Loom::Initialize");
    if (!m_mainModule)
    {
       // TODO: Log error
-      return;
+      return false;
    }
 
    Application app;
@@ -31,7 +33,7 @@ void Cypher::Loom::Initialize()
    app.fixedUpdateFunction = m_mainModule->GetFunction<UpdateFunction>(FUNCTION_NAME_FIXED_UPDATE);
    app.renderFunction = m_mainModule->GetFunction<RenderFunction>(FUNCTION_NAME_RENDER);
    
-   Console::Initialize(app);
+   return Console::Initialize(app);
 }
 
 void Cypher::Loom::Start()
@@ -58,6 +60,7 @@ void Cypher::Loom::LoadMainModule(const std::wstring& moduleName)
 
 Cypher::ModuleContext* Cypher::Loom::LoadModule(const std::wstring& moduleName)
 {
+   CYPHER_PROFILE_SCOPE("Loom::LoadModule");
    Module mod = ModuleLoader::Load(moduleName);
    if (!mod.IsLoaded())
    {
@@ -19,7 +19,7 @@ namespace Cypher
       Loom(const std::wstring& moduleName);
       ~Loom();
 
-      void Initialize();
+      bool Initialize();
       void Start();
 
    private:
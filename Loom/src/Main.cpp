@@ -2,8 +2,10 @@
 
 int main()
 {
-   Cypher::Loom loom(L"CypherTest.dll");
-   loom.Initialize();
+   Cypher::Loom loom(Cypher::Platform::GetLibraryFileName(L"CypherTest"));
+   if (!loom.Initialize())
+      return 1;
+
    loom.Start();
    return 0;
 }
\ No newline at end of file
@@ -1,10 +1,10 @@
 #pragma once
 
 #include <string>
-#include <Windows.h>
 #include <vector>
 
 #include "Core/Logger.h"
+#include "Core/Platform.h"
 #include "Types.h"
 
 namespace Cypher
@@ -26,10 +26,10 @@ namespace Cypher
             return nullptr;
          }
 
-         void* functionPtr = GetProcAddress(m_hModule, functionName);
+         void* functionPtr = Platform::GetModuleSymbol(m_hModule, functionName);
          if (!functionPtr)
          {
-            LOG_ERROR("Failed to get function \"", functionName, "\". Error code: ", GetLastError());
+            LOG_ERROR("Failed to get function \"", functionName, "\": ", Platform::GetModuleError());
             return nullptr;
          }
 
@@ -45,16 +45,16 @@ namespace Cypher
             return false;
          }
 
-         void* functionPtr = GetProcAddress(m_hModule, functionName);
+         void* functionPtr = Platform::GetModuleSymbol(m_hModule, functionName);
          return functionPtr != nullptr;
       }
 
       bool IsLoaded() const { return m_hModule != nullptr; }
       
-      HMODULE GetHandle() const { return m_hModule; }
-      void SetHandle(HMODULE hModule) { m_hModule = hModule; }
+      ModuleHandle GetHandle() const { return m_hModule; }
+      void SetHandle(ModuleHandle hModule) { m_hModule = hModule; }
       
    private:
-      HMODULE m_hModule;
+      ModuleHandle m_hModule;
    };
 }
@@ -1,5 +1,6 @@
 #include "ModuleLoader.h"
 
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 
@@ -9,7 +10,7 @@
 Cypher::Module Cypher::ModuleLoader::Load(const std::wstring& moduleName)
 {
    Module module;
-   HMODULE hModule = LoadLibrary(moduleName.c_str());
+   ModuleHandle hModule = Platform::OpenModule(moduleName);
    if (!hModule)
    {
       // TODO: Log error
@@ -24,14 +25,14 @@ void Cypher::ModuleLoader::Unload(Module& module)
 {
    if (module.IsLoaded())
    {
-      FreeLibrary(module.GetHandle());
+      Platform::CloseModule(module.GetHandle());
       module.SetHandle(nullptr);
    }
 }
 
 std::string Cypher::ModuleLoader::ComputeChecksum(const std::wstring& moduleName)
 {
-   std::vector<unsigned char> fileData = ReadFileBinary(moduleName);
+   FileBuffer fileData = ReadFileBinary(moduleName);
    if (fileData.empty())
    {
       //std::cerr << "Failed to read file data." << std::endl;
@@ -44,16 +45,16 @@ std::string Cypher::ModuleLoader::ComputeChecksum(const std::wstring& moduleName
    return Cypher::BytesToHexString(hash.begin(), hash.end());
 }
 
-std::vector<unsigned char> Cypher::ModuleLoader::ReadFileBinary(const std::wstring& moduleName)
+Cypher::ModuleLoader::FileBuffer Cypher::ModuleLoader::ReadFileBinary(const std::wstring& moduleName)
 {
-   std::ifstream file(moduleName, std::ios::binary | std::ios::ate);
+   std::ifstream file(std::filesystem::path(moduleName), std::ios::binary | std::ios::ate);
    if (!file)
       return {};
 
    std::streamsize size = file.tellg();
    file.seekg(0, std::ios::beg);
 
-   std::vector<unsigned char> buffer(size);
+   FileBuffer buffer(size);
    if (!file.read(reinterpret_cast<char*>(buffer.data()), size))
       return {};
 
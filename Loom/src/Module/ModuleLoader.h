@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 
+#include "Core/Memory.h"
 #include "Module.h"
 #include "Types.h"
 
@@ -17,7 +18,9 @@ namespace Cypher
       static std::string ComputeChecksum(const std::wstring& moduleName);
       
    private:
-      static std::vector<unsigned char> ReadFileBinary(const std::wstring& filePath);
+      using FileBuffer = std::vector<unsigned char, ArenaAllocator<unsigned char, MemoryArena::Loading>>;
+
+      static FileBuffer ReadFileBinary(const std::wstring& filePath);
 
       ModuleLoader() = default;
       ~ModuleLoader() = default;
@@ -1,3 +1,29 @@
+newoption {
+    trigger = "with-jemalloc",
+    description = "Back Cypher's memory arenas with jemalloc (links the library from --jemalloc-lib, or the system's)"
+}
+
+newoption {
+    trigger = "jemalloc-lib",
+    value = "PATH",
+    description = "Directory holding the jemalloc library for --with-jemalloc; the linker's default search path is used without it"
+}
+
+newoption {
+    trigger = "track-allocations",
+    description = "Count every allocation per frame and per scope through MemoryProfiler (replaces global operator new)"
+}
+
+newoption {
+    trigger = "avx2",
+    description = "Compile Cypher with AVX2 so cell span fills store 8 cells at a time instead of 4"
+}
+
+newoption {
+    trigger = "profile",
+    description = "Record CYPHER_PROFILE_SCOPE timings and write a Chrome trace when the console loop exits"
+}
+
 workspace "Cypher"
     architecture "x64"
     startproject "CypherTest"
@@ -9,11 +35,16 @@ workspace "Cypher"
     IncludeDir = {}
     IncludeDir["Cypher"] = "Cypher/src"
     IncludeDir["jemalloc"] = "Vendor/jemalloc/include"
+    IncludeDir["jemalloc_msvc"] = "Vendor/jemalloc/include/msvc_compat"
     IncludeDir["spdlog"] = "Vendor/spdlog/include"
     IncludeDir["glm"] = "Vendor/glm/include"
     IncludeDir["entt"] = "Vendor/entt/single_include"
     IncludeDir["box2d"] = "Vendor/box2d/include"
 
+    -- Only jemalloc's headers are vendored, and they are those of the MSVC build, so the library comes from outside
+    LibDir = {}
+    LibDir["jemalloc"] = _OPTIONS["jemalloc-lib"] and path.getabsolute(_OPTIONS["jemalloc-lib"])
+
     project "Cypher"
         location "Cypher"
         kind "StaticLib"
@@ -58,6 +89,28 @@ workspace "Cypher"
             runtime "Release"
             optimize "on"
 
+        filter "options:with-jemalloc"
+            defines { "CYPHER_USE_JEMALLOC" }
+
+        filter { "options:with-jemalloc", "system:windows" }
+            includedirs { "%{IncludeDir.jemalloc_msvc}" }
+
+        -- The vendored headers rename the API with the MSVC build's je_ prefix, which a system build doesn't use
+        filter { "options:with-jemalloc", "not system:windows" }
+            removeincludedirs { "%{IncludeDir.jemalloc}" }
+
+        filter "options:track-allocations"
+            defines { "CYPHER_TRACK_ALLOCATIONS" }
+
+        filter "options:profile"
+            defines { "CYPHER_PROFILE" }
+
+        filter "options:avx2"
+            vectorextensions "AVX2"
+
+        filter "system:linux"
+            pic "On"
+
     project "CypherTest"
         location "CypherTest"
         kind "SharedLib"
@@ -104,6 +157,20 @@ workspace "Cypher"
             runtime "Release"
             optimize "on"
 
+        filter "options:with-jemalloc"
+            libdirs { LibDir.jemalloc }
+            links { "jemalloc" }
+
+        filter "options:track-allocations"
+            defines { "CYPHER_TRACK_ALLOCATIONS" }
+
+        filter "options:profile"
+            defines { "CYPHER_PROFILE" }
+
+        filter "system:linux"
+            pic "On"
+            links { "pthread" }
+
     project "Loom"
         location "Loom"
         kind "ConsoleApp"
@@ -141,4 +208,77 @@ workspace "Cypher"
 
         filter "configurations:Release"
             runtime "Release"
-            optimize "on"
\ No newline at end of file
+            optimize "on"
+
+        filter "options:with-jemalloc"
+            libdirs { LibDir.jemalloc }
+            links { "jemalloc" }
+
+        filter "options:track-allocations"
+            defines { "CYPHER_TRACK_ALLOCATIONS" }
+
+        filter "options:profile"
+            defines { "CYPHER_PROFILE" }
+
+        -- The main module is copied next to the executable and opened by its bare file name, like LoadLibrary does on
+        -- Windows, so the executable's own directory goes on its run path
+        filter "system:linux"
+            links { "dl", "pthread" }
+            runpathdirs { "%{cfg.targetdir}" }
+
+    -- Microbenchmarks for the engine's containers, scheduler and renderer; run a Release build, optionally naming the
+    -- suites to run on the command line
+    project "Bench"
+        location "Bench"
+        kind "ConsoleApp"
+        language "C++"
+        cppdialect "C++20"
+        staticruntime "on"
+
+        targetdir ("bin/" .. outputdir .. "/%{prj.name}")
+        objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+        files {
+            "%{prj.location}/src/**.h",
+            "%{prj.location}/src/**.cpp",
+            "%{prj.location}/src/**.hpp"
+        }
+
+        includedirs {
+            "%{IncludeDir.Cypher}",
+            "%{IncludeDir.jemalloc}",
+            "%{IncludeDir.spdlog}",
+            "%{IncludeDir.glm}",
+            "%{IncludeDir.entt}",
+            "%{IncludeDir.box2d}"
+        }
+
+        links {
+            "Cypher"
+        }
+
+        defines { "_CRT_SECURE_NO_WARNINGS" }
+
+        filter "configurations:Debug"
+            runtime "Debug"
+            symbols "on"
+
+        filter "configurations:Release"
+            runtime "Release"
+            optimize "on"
+
+        filter "options:with-jemalloc"
+            libdirs { LibDir.jemalloc }
+            links { "jemalloc" }
+
+        filter "options:track-allocations"
+            defines { "CYPHER_TRACK_ALLOCATIONS" }
+
+        filter "options:profile"
+            defines { "CYPHER_PROFILE" }
+
+        filter "options:avx2"
+            vectorextensions "AVX2"
+
+        filter "system:linux"
+            links { "pthread" }
\ No newline at end of file